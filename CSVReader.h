@@ -2,242 +2,352 @@
 #define CSV_READER_H
 
 #include "Student.h"
-#include <fstream>
+#include "MappedFile.h"
+#include "ThreadPool.h"
+#include "Metrics.h"
+#include <chrono>
+#include <cctype>
+#include <charconv>
+#include <cstring>
 #include <sstream>
 #include <string>
+#include <string_view>
+#include <algorithm>
+#include <type_traits>
 #include <vector>
 #include <memory>
 #include <iostream>
 
+struct CSVReadStats {
+    size_t bytesRead = 0;
+    size_t rowsRead = 0;
+    size_t rowsRejected = 0;
+    size_t entriesRejected = 0;
+
+    CSVReadStats& operator+=(const CSVReadStats& other) {
+        bytesRead += other.bytesRead;
+        rowsRead += other.rowsRead;
+        rowsRejected += other.rowsRejected;
+        entriesRejected += other.entriesRejected;
+        return *this;
+    }
+};
+
 class CSVReader {
 private:
-    static std::string trim(const std::string& str) {
+    static std::string_view trimView(std::string_view str) {
         size_t first = str.find_first_not_of(" \t\n\r");
-        if (first == std::string::npos) return "";
+        if (first == std::string_view::npos) return std::string_view();
         size_t last = str.find_last_not_of(" \t\n\r");
         return str.substr(first, (last - first + 1));
     }
-    
-public:
-    static std::vector<std::shared_ptr<Student<std::string, std::string>>> 
-    readStudentsStringString(const std::string& filename) {
-        std::vector<std::shared_ptr<Student<std::string, std::string>>> students;
-        std::ifstream file(filename);
-        
-        if (!file.is_open()) {
-            std::cerr << "Error: Could not open file " << filename << std::endl;
-            return students;
-        }
-        
-        std::string line;
-        if (std::getline(file, line)) {
-            if (line.find("name") == std::string::npos && 
-                line.find("roll") == std::string::npos) {
-                file.seekg(0);
-            }
+
+    // Converts a whole trimmed field to T without throwing. Strings are copied
+    // as-is, string course codes are interned, arithmetic types go through
+    // std::from_chars, anything else falls back to operator>>.
+    template<typename T>
+    static bool parseField(std::string_view str, T& value) {
+        if constexpr (std::is_same_v<T, std::string>) {
+            value.assign(str.data(), str.size());
+            return true;
+        } else if constexpr (std::is_same_v<T, InternedCourse>) {
+            value = InternedCourse::intern(str);
+            return true;
+        } else if constexpr (std::is_arithmetic_v<T> && !std::is_same_v<T, bool>) {
+            const char* end = str.data() + str.size();
+            auto result = std::from_chars(str.data(), end, value);
+            return result.ec == std::errc() && result.ptr == end && !str.empty();
         } else {
-            file.seekg(0);
+            std::istringstream in{std::string(str)};
+            in >> value;
+            return !in.fail() && (in >> std::ws).eof();
         }
-        
-        while (std::getline(file, line)) {
-            if (line.empty()) continue;
+    }
+
+    template<typename Fn>
+    static void forEachField(std::string_view str, char delimiter, Fn&& fn) {
+        size_t start = 0;
+        while (start <= str.size()) {
+            size_t end = str.find(delimiter, start);
+            if (end == std::string_view::npos) end = str.size();
+            fn(str.substr(start, end - start));
+            start = end + 1;
+        }
+    }
+
+    template<typename R, typename C>
+    static void parseCurrentCourses(std::string_view courses, Student<R, C>& student,
+                                    CSVReadStats& stats) {
+        forEachField(courses, ';', [&](std::string_view entry) {
+            entry = trimView(entry);
+            if (entry.empty()) return;
             
-            std::istringstream ss(line);
-            std::string token;
-            std::vector<std::string> tokens;
+            size_t colonPos = entry.find(':');
+            std::string_view codeField = trimView(entry.substr(0, colonPos));
+            CourseKey<C> courseCode;
+            if (codeField.empty() || !parseField(codeField, courseCode)) {
+                stats.entriesRejected++;
+                return;
+            }
             
-            while (std::getline(ss, token, ',')) {
-                tokens.push_back(trim(token));
+            double grade = 0.0;
+            if (colonPos != std::string_view::npos &&
+                parseField(trimView(entry.substr(colonPos + 1)), grade) && grade != 0.0) {
+                student.addPreviousCourse(courseCode, grade);
+            } else {
+                student.addCurrentCourse(courseCode, 0.0);
             }
+        });
+    }
+
+    template<typename R, typename C>
+    static void parsePreviousCourses(std::string_view courses, Student<R, C>& student,
+                                     CSVReadStats& stats) {
+        forEachField(courses, ';', [&](std::string_view entry) {
+            entry = trimView(entry);
+            if (entry.empty()) return;
             
-            if (tokens.size() >= 4) {
-                try {
-                    std::string name = tokens[0];
-                    std::string rollNumber = tokens[1];
-                    std::string branch = tokens[2];
-                    int startingYear = std::stoi(tokens[3]);
-                    
-                    auto student = std::make_shared<Student<std::string, std::string>>(
-                        name, rollNumber, branch, startingYear);
-                    
-                    if (tokens.size() > 4) {
-                        if (!tokens[4].empty()) {
-                            std::istringstream currentCoursesStream(tokens[4]);
-                            std::string courseEntry;
-                            while (std::getline(currentCoursesStream, courseEntry, ';')) {
-                                courseEntry = trim(courseEntry);
-                                if (courseEntry.empty()) continue;
-                                
-                                size_t colonPos = courseEntry.find(':');
-                                if (colonPos != std::string::npos) {
-                                    std::string courseCode = trim(courseEntry.substr(0, colonPos));
-                                    std::string gradeStr = trim(courseEntry.substr(colonPos + 1));
-                                    if (!courseCode.empty()) {
-                                        try {
-                                            double grade = std::stod(gradeStr);
-                                            if (grade == 0.0) {
-                                                student->addCurrentCourse(courseCode, 0.0);
-                                            } else {
-                                                student->addPreviousCourse(courseCode, grade);
-                                            }
-                                        } catch (...) {
-                                            student->addCurrentCourse(courseCode, 0.0);
-                                        }
-                                    }
-                                } else {
-                                    student->addCurrentCourse(trim(courseEntry), 0.0);
-                                }
-                            }
-                        }
-                        
-                        if (tokens.size() > 5 && !tokens[5].empty()) {
-                            std::istringstream previousCoursesStream(tokens[5]);
-                            std::string courseEntry;
-                            while (std::getline(previousCoursesStream, courseEntry, ';')) {
-                                courseEntry = trim(courseEntry);
-                                if (courseEntry.empty()) continue;
-                                
-                                size_t colonPos = courseEntry.find(':');
-                                if (colonPos != std::string::npos) {
-                                    std::string courseCode = trim(courseEntry.substr(0, colonPos));
-                                    std::string gradeStr = trim(courseEntry.substr(colonPos + 1));
-                                    if (!courseCode.empty() && !gradeStr.empty()) {
-                                        try {
-                                            double grade = std::stod(gradeStr);
-                                            student->addPreviousCourse(courseCode, grade);
-                                        } catch (...) {
-                                        }
-                                    }
-                                }
-                            }
-                        }
-                    }
-                    
-                    students.push_back(student);
-                } catch (...) {
-                    continue;
-                }
+            size_t colonPos = entry.find(':');
+            CourseKey<C> courseCode;
+            double grade = 0.0;
+            if (colonPos == std::string_view::npos) {
+                stats.entriesRejected++;
+                return;
+            }
+            std::string_view codeField = trimView(entry.substr(0, colonPos));
+            if (codeField.empty() || !parseField(codeField, courseCode) ||
+                !parseField(trimView(entry.substr(colonPos + 1)), grade)) {
+                stats.entriesRejected++;
+                return;
             }
+            student.addPreviousCourse(courseCode, grade);
+        });
+    }
+
+    template<typename R, typename C>
+    static std::shared_ptr<Student<R, C>> parseStudentLine(std::string_view line,
+                                                           CSVReadStats& stats) {
+        std::string_view tokens[6];
+        size_t tokenCount = 0;
+        forEachField(line, ',', [&](std::string_view field) {
+            if (tokenCount < 6) tokens[tokenCount] = trimView(field);
+            tokenCount++;
+        });
+        
+        R rollNumber{};
+        int startingYear = 0;
+        if (tokenCount < 4 || !parseField(tokens[1], rollNumber) ||
+            !parseField(tokens[3], startingYear)) {
+            return nullptr;
         }
         
-        file.close();
-        return students;
+        auto student = std::make_shared<Student<R, C>>(
+            std::string(tokens[0]), rollNumber, std::string(tokens[2]), startingYear);
+        
+        if (tokenCount > 4 && !tokens[4].empty()) {
+            parseCurrentCourses(tokens[4], *student, stats);
+        }
+        if (tokenCount > 5 && !tokens[5].empty()) {
+            parsePreviousCourses(tokens[5], *student, stats);
+        }
+        return student;
+    }
+
+    // Returns the line starting at pos and moves pos past its newline.
+    static std::string_view nextLine(std::string_view data, size_t& pos) {
+        const void* newline = std::memchr(data.data() + pos, '\n', data.size() - pos);
+        size_t end = newline ? static_cast<const char*>(newline) - data.data() : data.size();
+        std::string_view line = data.substr(pos, end - pos);
+        pos = end + 1;
+        return line;
     }
     
-    static std::vector<std::shared_ptr<Student<std::string, int>>> 
-    readStudentsStringInt(const std::string& filename) {
-        std::vector<std::shared_ptr<Student<std::string, int>>> students;
-        std::ifstream file(filename);
-        
-        if (!file.is_open()) {
-            std::cerr << "Error: Could not open file " << filename << std::endl;
-            return students;
+    // A header names its columns, so it mentions the name or roll number
+    // column in any case.
+    static bool looksLikeHeader(std::string_view line) {
+        std::string lower(line);
+        std::transform(lower.begin(), lower.end(), lower.begin(),
+                       [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        return lower.find("name") != std::string::npos ||
+               lower.find("roll") != std::string::npos;
+    }
+    
+    // Parses one line into out. The first non-empty line of the file is
+    // skipped without being counted if it is a header; any other line that
+    // does not parse as a student is counted as a rejected row.
+    template<typename R, typename C>
+    static void parseLine(std::string_view line, bool& mayHaveHeader,
+                          std::vector<std::shared_ptr<Student<R, C>>>& students,
+                          CSVReadStats& stats) {
+        if (trimView(line).empty()) return;
+        auto student = parseStudentLine<R, C>(line, stats);
+        if (student) {
+            students.push_back(std::move(student));
+            stats.rowsRead++;
+        } else if (!mayHaveHeader || !looksLikeHeader(line)) {
+            stats.rowsRejected++;
+        }
+        mayHaveHeader = false;
+    }
+    
+    template<typename R, typename C>
+    static void parseLines(std::string_view data, bool mayHaveHeader,
+                           std::vector<std::shared_ptr<Student<R, C>>>& students,
+                           CSVReadStats& stats) {
+        stats.bytesRead += data.size();
+        size_t pos = 0;
+        while (pos < data.size()) {
+            parseLine<R, C>(nextLine(data, pos), mayHaveHeader, students, stats);
         }
+    }
+    
+    static void reportStats(const std::string& filename, const CSVReadStats& localStats,
+                            CSVReadStats* stats, std::chrono::nanoseconds parseTime) {
+        Metrics::instance().recordParse(localStats.rowsRead, localStats.rowsRejected,
+                                        localStats.entriesRejected, localStats.bytesRead,
+                                        parseTime);
+        if (stats) {
+            *stats = localStats;
+        } else if (localStats.rowsRejected > 0 || localStats.entriesRejected > 0) {
+            std::cerr << "Warning: " << filename << ": skipped "
+                      << localStats.rowsRejected << " malformed rows and "
+                      << localStats.entriesRejected << " malformed course entries" << std::endl;
+        }
+    }
+    
+    // Splits data into numThreads chunks that each end on a newline, parses
+    // every chunk as a task on the shared ThreadPool and concatenates the results in file order.
+    template<typename R, typename C>
+    static std::vector<std::shared_ptr<Student<R, C>>> parseChunks(std::string_view data,
+                                                                   int numThreads,
+                                                                   CSVReadStats& stats) {
+        if (numThreads < 1) numThreads = 1;
         
-        std::string line;
-        if (std::getline(file, line)) {
-            if (line.find("name") == std::string::npos && 
-                line.find("roll") == std::string::npos) {
-                file.seekg(0);
+        std::vector<size_t> bounds = {0};
+        for (int i = 1; i < numThreads; ++i) {
+            size_t target = std::max(bounds.back(), data.size() * i / numThreads);
+            size_t newline = data.find('\n', target);
+            size_t bound = newline == std::string_view::npos ? data.size() : newline + 1;
+            if (bound > bounds.back() && bound < data.size()) {
+                bounds.push_back(bound);
             }
-        } else {
-            file.seekg(0);
         }
+        bounds.push_back(data.size());
         
-        while (std::getline(file, line)) {
-            if (line.empty()) continue;
-            
-            std::istringstream ss(line);
-            std::string token;
-            std::vector<std::string> tokens;
-            
-            while (std::getline(ss, token, ',')) {
-                tokens.push_back(trim(token));
-            }
-            
-            if (tokens.size() >= 4) {
-                try {
-                    std::string name = tokens[0];
-                    std::string rollNumber = tokens[1];
-                    std::string branch = tokens[2];
-                    int startingYear = std::stoi(tokens[3]);
-                    
-                    auto student = std::make_shared<Student<std::string, int>>(
-                        name, rollNumber, branch, startingYear);
-                    
-                    if (tokens.size() > 4) {
-                        if (!tokens[4].empty()) {
-                            std::istringstream currentCoursesStream(tokens[4]);
-                            std::string courseEntry;
-                            while (std::getline(currentCoursesStream, courseEntry, ';')) {
-                                courseEntry = trim(courseEntry);
-                                if (courseEntry.empty()) continue;
-                                
-                                size_t colonPos = courseEntry.find(':');
-                                if (colonPos != std::string::npos) {
-                                    std::string courseCodeStr = trim(courseEntry.substr(0, colonPos));
-                                    std::string gradeStr = trim(courseEntry.substr(colonPos + 1));
-                                    if (!courseCodeStr.empty()) {
-                                        try {
-                                            int courseCode = std::stoi(courseCodeStr);
-                                            double grade = std::stod(gradeStr);
-                                            if (grade == 0.0) {
-                                                student->addCurrentCourse(courseCode, 0.0);
-                                            } else {
-                                                student->addPreviousCourse(courseCode, grade);
-                                            }
-                                        } catch (...) {
-                                            try {
-                                                int courseCode = std::stoi(courseCodeStr);
-                                                student->addCurrentCourse(courseCode, 0.0);
-                                            } catch (...) {
-                                            }
-                                        }
-                                    }
-                                } else {
-                                    try {
-                                        int courseCode = std::stoi(trim(courseEntry));
-                                        student->addCurrentCourse(courseCode, 0.0);
-                                    } catch (...) {
-                                    }
-                                }
-                            }
-                        }
-                        
-                        if (tokens.size() > 5 && !tokens[5].empty()) {
-                            std::istringstream previousCoursesStream(tokens[5]);
-                            std::string courseEntry;
-                            while (std::getline(previousCoursesStream, courseEntry, ';')) {
-                                courseEntry = trim(courseEntry);
-                                if (courseEntry.empty()) continue;
-                                
-                                size_t colonPos = courseEntry.find(':');
-                                if (colonPos != std::string::npos) {
-                                    std::string courseCodeStr = trim(courseEntry.substr(0, colonPos));
-                                    std::string gradeStr = trim(courseEntry.substr(colonPos + 1));
-                                    if (!courseCodeStr.empty() && !gradeStr.empty()) {
-                                        try {
-                                            int courseCode = std::stoi(courseCodeStr);
-                                            double grade = std::stod(gradeStr);
-                                            student->addPreviousCourse(courseCode, grade);
-                                        } catch (...) {
-                                        }
-                                    }
-                                }
-                            }
-                        }
-                    }
-                    
-                    students.push_back(student);
-                } catch (...) {
-                    continue;
-                }
-            }
+        size_t chunkCount = bounds.size() - 1;
+        std::vector<std::vector<std::shared_ptr<Student<R, C>>>> chunks(chunkCount);
+        std::vector<CSVReadStats> chunkStats(chunkCount);
+        TaskGroup group;
+        for (size_t i = 1; i < chunkCount; ++i) {
+            group.run([&chunks, &chunkStats, &bounds, data, i]() {
+                parseLines<R, C>(data.substr(bounds[i], bounds[i + 1] - bounds[i]), false,
+                                 chunks[i], chunkStats[i]);
+            });
+        }
+        parseLines<R, C>(data.substr(bounds[0], bounds[1] - bounds[0]), true,
+                         chunks[0], chunkStats[0]);
+        group.wait();
+        
+        size_t total = 0;
+        for (size_t i = 0; i < chunkCount; ++i) {
+            total += chunks[i].size();
+            stats += chunkStats[i];
+        }
+        std::vector<std::shared_ptr<Student<R, C>>> students;
+        students.reserve(total);
+        for (auto& chunk : chunks) {
+            students.insert(students.end(), std::make_move_iterator(chunk.begin()),
+                            std::make_move_iterator(chunk.end()));
+        }
+        return students;
+    }
+
+public:
+    // Reads students with roll numbers of type R and course codes of type C.
+    // The file is memory-mapped and tokenized in place; with numThreads > 1 it
+    // is parsed in parallel chunks. Malformed rows and course entries are
+    // skipped and counted in stats, or reported on std::cerr if stats is null.
+    template<typename R, typename C>
+    static std::vector<std::shared_ptr<Student<R, C>>> read(const std::string& filename,
+                                                           int numThreads = 1,
+                                                           CSVReadStats* stats = nullptr) {
+        MappedFile file(filename);
+        
+        if (!file.isOpen()) {
+            std::cerr << "Error: Could not open file " << filename << std::endl;
+            return std::vector<std::shared_ptr<Student<R, C>>>();
         }
         
-        file.close();
+        CSVReadStats localStats;
+        auto start = std::chrono::steady_clock::now();
+        auto students = parseChunks<R, C>(file.view(), numThreads, localStats);
+        reportStats(filename, localStats, stats, std::chrono::steady_clock::now() - start);
         return students;
     }
+    
+    // Streams students from filename in file order without materializing
+    // the whole file: every batchSize parsed students are passed to
+    // onBatch(std::vector<std::shared_ptr<Student<R, C>>>&), which may move
+    // them out, and the file pages already parsed are released. Memory use
+    // is bounded by one batch. Returns false if the file cannot be opened.
+    template<typename R, typename C, typename BatchFn>
+    static bool readBatches(const std::string& filename, size_t batchSize, BatchFn&& onBatch,
+                            CSVReadStats* stats = nullptr) {
+        MappedFile file(filename);
+        
+        if (!file.isOpen()) {
+            std::cerr << "Error: Could not open file " << filename << std::endl;
+            return false;
+        }
+        
+        if (batchSize == 0) batchSize = 1;
+        std::string_view data = file.view();
+        CSVReadStats localStats;
+        localStats.bytesRead = data.size();
+        std::vector<std::shared_ptr<Student<R, C>>> batch;
+        batch.reserve(batchSize);
+        bool mayHaveHeader = true;
+        size_t pos = 0;
+        // Parse time excludes the time spent in onBatch.
+        std::chrono::nanoseconds parseTime{0};
+        auto start = std::chrono::steady_clock::now();
+        while (pos < data.size()) {
+            parseLine<R, C>(nextLine(data, pos), mayHaveHeader, batch, localStats);
+            if (batch.size() >= batchSize) {
+                parseTime += std::chrono::steady_clock::now() - start;
+                onBatch(batch);
+                batch.clear();
+                file.discardBefore(pos);
+                start = std::chrono::steady_clock::now();
+            }
+        }
+        parseTime += std::chrono::steady_clock::now() - start;
+        if (!batch.empty()) {
+            onBatch(batch);
+        }
+        reportStats(filename, localStats, stats, parseTime);
+        return true;
+    }
+
+    static std::vector<std::shared_ptr<Student<std::string, std::string>>>
+    readStudentsMapped(const std::string& filename) {
+        return read<std::string, std::string>(filename);
+    }
+
+    static std::vector<std::shared_ptr<Student<std::string, std::string>>>
+    readStudentsParallel(const std::string& filename, int numThreads) {
+        return read<std::string, std::string>(filename, numThreads);
+    }
+
+    static std::vector<std::shared_ptr<Student<std::string, std::string>>>
+    readStudentsStringString(const std::string& filename) {
+        return read<std::string, std::string>(filename);
+    }
+
+    static std::vector<std::shared_ptr<Student<std::string, int>>>
+    readStudentsStringInt(const std::string& filename) {
+        return read<std::string, int>(filename);
+    }
 };
 
 #endif
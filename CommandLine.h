@@ -0,0 +1,325 @@
+#ifndef COMMAND_LINE_H
+#define COMMAND_LINE_H
+
+#include "StudentRegistry.h"
+#include "CSVReader.h"
+#include "Metrics.h"
+#include "QueryServer.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <csignal>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+// A "COURSE:GRADE" query: students with grade >= minGrade in course.
+struct GradeQuery {
+    std::string course;
+    double minGrade = 0.0;
+    // The grade as written, echoed in the output so it reads as given.
+    std::string threshold;
+};
+
+// Parses "COURSE:GRADE", splitting at the last ':' so course codes may
+// contain one. Returns false unless both parts are present and the grade is
+// a complete number.
+inline bool parseGradeQuery(std::string_view text, GradeQuery& query) {
+    size_t first = text.find_first_not_of(" \t\r\n");
+    size_t last = text.find_last_not_of(" \t\r\n");
+    if (first == std::string_view::npos) return false;
+    text = text.substr(first, last - first + 1);
+    size_t colon = text.rfind(':');
+    if (colon == std::string_view::npos || colon == 0 || colon + 1 == text.size()) {
+        return false;
+    }
+    std::string grade(text.substr(colon + 1));
+    char* end = nullptr;
+    double value = std::strtod(grade.c_str(), &end);
+    if (end != grade.c_str() + grade.size() || std::isnan(value)) return false;
+    query.course = std::string(text.substr(0, colon));
+    query.minGrade = value;
+    query.threshold = std::move(grade);
+    return true;
+}
+
+// Options of the non-interactive mode, e.g.
+//   erp_system --load students.csv --query OOPD:9.0 --sort --threads 8
+//   erp_system --load students.csv --serve /tmp/erp.sock
+struct CommandLineOptions {
+    std::string csvFile = "students.csv";
+    std::vector<GradeQuery> queries;
+    std::string replayFile;
+    bool sort = false;
+    SortEngine engine = SortEngine::Comparison;
+    int threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    size_t limit = SIZE_MAX;
+    std::string serveSocket;
+    bool printMetrics = false;
+    bool showHelp = false;
+};
+
+inline void printCommandLineUsage(const char* program) {
+    std::cout << "Usage: " << program << " [options]\n"
+              << "  --load FILE        CSV file to load (default students.csv)\n"
+              << "  --query C:G        list students with grade >= G in course C (repeatable)\n"
+              << "  --replay FILE      run every C:G line of FILE as a query and report throughput\n"
+              << "  --sort             parallel-sort the loaded students by roll number\n"
+              << "  --engine E         sort engine: comparison (default) or radix\n"
+              << "  --threads N        threads for loading and sorting (default: all cores)\n"
+              << "  --limit N          list at most N students per query or sort\n"
+              << "  --serve PATH       serve queries on Unix socket PATH until SIGINT/SIGTERM\n"
+              << "  --metrics          print the collected metrics at the end\n"
+              << "  --help             show this help\n"
+              << "Without options the interactive menu starts.\n";
+}
+
+// Fills options from argv. Returns false, after reporting on std::cerr, on
+// an unknown option or a missing or malformed value.
+inline bool parseCommandLine(int argc, char** argv, CommandLineOptions& options) {
+    auto value = [&](int& i) -> const char* {
+        if (i + 1 >= argc) {
+            std::cerr << "Error: " << argv[i] << " needs a value" << std::endl;
+            return nullptr;
+        }
+        return argv[++i];
+    };
+    auto count = [](const char* text, size_t& out) {
+        char* end = nullptr;
+        unsigned long long parsed = std::strtoull(text, &end, 10);
+        if (*text == '\0' || *text == '-' || *end != '\0') return false;
+        out = static_cast<size_t>(parsed);
+        return true;
+    };
+
+    for (int i = 1; i < argc; ++i) {
+        std::string option = argv[i];
+        const char* text = nullptr;
+        if (option == "--help" || option == "-h") {
+            options.showHelp = true;
+        } else if (option == "--sort") {
+            options.sort = true;
+        } else if (option == "--metrics") {
+            options.printMetrics = true;
+        } else if (option == "--load") {
+            if (!(text = value(i))) return false;
+            options.csvFile = text;
+        } else if (option == "--serve") {
+            if (!(text = value(i))) return false;
+            options.serveSocket = text;
+        } else if (option == "--replay") {
+            if (!(text = value(i))) return false;
+            options.replayFile = text;
+        } else if (option == "--query") {
+            if (!(text = value(i))) return false;
+            GradeQuery query;
+            if (!parseGradeQuery(text, query)) {
+                std::cerr << "Error: Invalid query '" << text << "', expected COURSE:GRADE"
+                          << std::endl;
+                return false;
+            }
+            options.queries.push_back(query);
+        } else if (option == "--engine") {
+            if (!(text = value(i))) return false;
+            std::string engine = text;
+            if (engine == "comparison") {
+                options.engine = SortEngine::Comparison;
+            } else if (engine == "radix") {
+                options.engine = SortEngine::Radix;
+            } else {
+                std::cerr << "Error: Unknown sort engine '" << engine << "'" << std::endl;
+                return false;
+            }
+        } else if (option == "--threads") {
+            size_t threads = 0;
+            if (!(text = value(i))) return false;
+            if (!count(text, threads) || threads == 0 || threads > 4096) {
+                std::cerr << "Error: Invalid thread count '" << text << "'" << std::endl;
+                return false;
+            }
+            options.threads = static_cast<int>(threads);
+        } else if (option == "--limit") {
+            if (!(text = value(i))) return false;
+            if (!count(text, options.limit)) {
+                std::cerr << "Error: Invalid limit '" << text << "'" << std::endl;
+                return false;
+            }
+        } else {
+            std::cerr << "Error: Unknown option '" << option << "'" << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+// The server --serve is running, for the SIGINT/SIGTERM handler.
+inline QueryServer* activeQueryServer = nullptr;
+
+// Serves options.csvFile on options.serveSocket until SIGINT or SIGTERM.
+// The file is loaded up front and, when it changes on disk, reloaded in the
+// background while the server keeps answering from the old data.
+inline int runQueryServer(const CommandLineOptions& options) {
+    QueryServer::Dataset dataset(options.csvFile, options.threads);
+    auto data = dataset.get();
+    if (!data || data->registry.size() == 0) {
+        std::cerr << "Error: No students loaded from " << options.csvFile << std::endl;
+        return 1;
+    }
+    QueryServer server(dataset, options.serveSocket);
+    if (!server.start()) return 1;
+    std::cout << "serving " << data->registry.size() << " students from " << options.csvFile
+              << " on " << options.serveSocket << std::endl;
+    data.reset();
+
+    activeQueryServer = &server;
+    auto onSignal = [](int) { activeQueryServer->stop(); };
+    std::signal(SIGINT, onSignal);
+    std::signal(SIGTERM, onSignal);
+    server.run();
+    std::signal(SIGINT, SIG_DFL);
+    std::signal(SIGTERM, SIG_DFL);
+    activeQueryServer = nullptr;
+
+    if (options.printMetrics) {
+        std::cout << Metrics::instance().snapshot().toText();
+    }
+    std::cout << "server stopped" << std::endl;
+    return 0;
+}
+
+// Loads options.csvFile once, then runs the queries, the sort and the replay
+// with no prompts, printing results and timings to stdout. Returns the
+// process exit code: 0 on success, 1 if the file or replay cannot be read or
+// the sort check fails.
+inline int runCommandLine(const CommandLineOptions& options) {
+    if (!options.serveSocket.empty()) {
+        return runQueryServer(options);
+    }
+    using Registry = StudentRegistry<std::string, std::string>;
+    using Clock = std::chrono::steady_clock;
+    auto millisecondsSince = [](Clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    };
+    std::cout << std::fixed << std::setprecision(3);
+
+    CSVReadStats stats;
+    auto start = Clock::now();
+    auto students = CSVReader::read<std::string, std::string>(options.csvFile, options.threads,
+                                                              &stats);
+    Registry registry;
+    registry.addStudents(students);
+    double loadMs = millisecondsSince(start);
+    if (students.empty()) {
+        std::cerr << "Error: No students loaded from " << options.csvFile << std::endl;
+        return 1;
+    }
+    std::cout << "load " << options.csvFile << ": " << students.size() << " students, "
+              << stats.rowsRejected << " rejected rows, " << stats.entriesRejected
+              << " rejected entries, " << loadMs << " ms\n";
+
+    // A query's time (and its grade query latency in Metrics) covers the
+    // lookup and collecting the students it lists, not printing them.
+    for (const auto& query : options.queries) {
+        std::vector<std::pair<const Student<std::string, std::string>*, double>> listed;
+        size_t matches = 0;
+        start = Clock::now();
+        {
+            Metrics::ScopedTimer timer(Metrics::instance().gradeQueries());
+            auto range = registry.gradeRange(query.course, query.minGrade);
+            matches = range.size();
+            listed.reserve(std::min(matches, options.limit));
+            for (auto it = range.begin(); it != range.end() && listed.size() < options.limit;
+                 ++it) {
+                listed.emplace_back(*it, it.grade());
+            }
+        }
+        double queryMs = millisecondsSince(start);
+        std::cout << "query " << query.course << ">=" << query.threshold << ": " << matches
+                  << " students, " << std::setprecision(3) << queryMs << " ms\n";
+        for (const auto& [student, grade] : listed) {
+            std::cout << "  " << student->getName() << " (" << student->getRollNumber()
+                      << ") - Grade: " << std::setprecision(1) << grade
+                      << std::setprecision(3) << "\n";
+        }
+    }
+
+    int status = 0;
+    if (options.sort) {
+        auto sorted = students;
+        std::vector<std::chrono::microseconds> threadTimes;
+        SortPhaseTimes phaseTimes;
+        Registry::parallelSort(sorted, options.threads, threadTimes, phaseTimes, options.engine);
+        bool ordered = std::is_sorted(sorted.begin(), sorted.end(),
+                                      [](const auto& a, const auto& b) { return *a < *b; });
+        if (!ordered) status = 1;
+        std::cout << "sort: " << sorted.size() << " students, " << options.threads
+                  << " threads, " << (options.engine == SortEngine::Radix ? "radix" : "comparison")
+                  << " engine, " << phaseTimes.total.count() / 1000.0 << " ms (chunk sort "
+                  << phaseTimes.sort.count() / 1000.0 << " ms, merge "
+                  << phaseTimes.merge.count() / 1000.0 << " ms), "
+                  << (ordered ? "verified" : "NOT SORTED") << "\n";
+        for (size_t i = 0; i < sorted.size() && i < options.limit; ++i) {
+            std::cout << "  " << sorted[i]->getRollNumber() << " - " << sorted[i]->getName()
+                      << "\n";
+        }
+    }
+
+    if (!options.replayFile.empty()) {
+        std::ifstream in(options.replayFile);
+        if (!in) {
+            std::cerr << "Error: Could not open file " << options.replayFile << std::endl;
+            return 1;
+        }
+        std::vector<GradeQuery> queries;
+        size_t malformed = 0;
+        std::string line;
+        while (std::getline(in, line)) {
+            if (line.find_first_not_of(" \t\r") == std::string::npos) continue;
+            GradeQuery query;
+            if (parseGradeQuery(line, query)) {
+                queries.push_back(std::move(query));
+            } else {
+                malformed++;
+            }
+        }
+
+        // Each query copies its result out, as a caller of
+        // getStudentsWithGrade would.
+        std::vector<double> latencies;
+        latencies.reserve(queries.size());
+        size_t hits = 0;
+        start = Clock::now();
+        for (const auto& query : queries) {
+            auto queryStart = Clock::now();
+            hits += registry.getStudentsWithGrade(query.course, query.minGrade).size();
+            latencies.push_back(std::chrono::duration<double, std::micro>(
+                Clock::now() - queryStart).count());
+        }
+        double totalMs = millisecondsSince(start);
+        std::sort(latencies.begin(), latencies.end());
+        auto percentile = [&latencies](double percent) {
+            if (latencies.empty()) return 0.0;
+            size_t rank = static_cast<size_t>(std::ceil(percent * latencies.size() / 100.0));
+            return latencies[std::clamp<size_t>(rank, 1, latencies.size()) - 1];
+        };
+        std::cout << "replay " << options.replayFile << ": " << queries.size() << " queries, "
+                  << malformed << " malformed lines, " << hits << " hits, " << totalMs
+                  << " ms, " << (totalMs > 0.0 ? queries.size() * 1000.0 / totalMs : 0.0)
+                  << " queries/s, p50 " << percentile(50.0) << " us, p99 " << percentile(99.0)
+                  << " us, max " << (latencies.empty() ? 0.0 : latencies.back()) << " us\n";
+    }
+
+    if (options.printMetrics) {
+        std::cout << Metrics::instance().snapshot().toText();
+    }
+    std::cout.flush();
+    return status;
+}
+
+#endif
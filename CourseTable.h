@@ -0,0 +1,147 @@
+#ifndef COURSE_TABLE_H
+#define COURSE_TABLE_H
+
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <ostream>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+
+using CourseId = std::uint32_t;
+
+// Id of the "no course" value a default-constructed InternedCourse holds. It
+// is never in a CourseTable, so it indexes no per-course data.
+inline constexpr CourseId noCourse = UINT32_MAX;
+
+// Process-wide table mapping course codes to dense integer ids. Entries are
+// never removed or moved, so pointers to them stay valid for the lifetime of
+// the program and can be shared between threads without locking.
+template<typename C>
+class CourseTable {
+public:
+    struct Entry {
+        C code;
+        CourseId id;
+    };
+
+    using LookupKey = std::conditional_t<std::is_same_v<C, std::string>, std::string_view, C>;
+
+private:
+    mutable std::shared_mutex tableMutex;
+    std::deque<Entry> entries;
+    std::unordered_map<LookupKey, const Entry*> byCode;
+
+    CourseTable() = default;
+
+public:
+    CourseTable(const CourseTable&) = delete;
+    CourseTable& operator=(const CourseTable&) = delete;
+
+    static CourseTable& instance() {
+        static CourseTable table;
+        return table;
+    }
+
+    const Entry* find(const LookupKey& code) const {
+        std::shared_lock<std::shared_mutex> lock(tableMutex);
+        auto it = byCode.find(code);
+        return it != byCode.end() ? it->second : nullptr;
+    }
+
+    const Entry* intern(const LookupKey& code) {
+        if (const Entry* entry = find(code)) return entry;
+
+        std::unique_lock<std::shared_mutex> lock(tableMutex);
+        auto it = byCode.find(code);
+        if (it != byCode.end()) return it->second;
+
+        entries.push_back(Entry{C(code), static_cast<CourseId>(entries.size())});
+        const Entry* entry = &entries.back();
+        byCode.emplace(LookupKey(entry->code), entry);
+        return entry;
+    }
+
+    const C& code(CourseId id) const {
+        std::shared_lock<std::shared_mutex> lock(tableMutex);
+        return entries[id].code;
+    }
+
+    size_t size() const {
+        std::shared_lock<std::shared_mutex> lock(tableMutex);
+        return entries.size();
+    }
+};
+
+// A course code stored as a pointer into CourseTable. Copies and equality
+// checks are pointer-sized; ordering still follows the code's string order
+// so course maps keep iterating alphabetically.
+class InternedCourse {
+private:
+    const CourseTable<std::string>::Entry* entry = nullptr;
+
+    explicit InternedCourse(const CourseTable<std::string>::Entry* entry) : entry(entry) {}
+
+    // Shared by every default-constructed course without interning "", so
+    // no phantom empty course appears in the table or in snapshots.
+    static const CourseTable<std::string>::Entry* none() {
+        static const CourseTable<std::string>::Entry entry{std::string(), noCourse};
+        return &entry;
+    }
+
+public:
+    InternedCourse() : entry(none()) {}
+    InternedCourse(const std::string& code) : InternedCourse(intern(code)) {}
+    InternedCourse(const char* code) : InternedCourse(intern(std::string_view(code))) {}
+
+    static InternedCourse intern(std::string_view code) {
+        return InternedCourse(CourseTable<std::string>::instance().intern(code));
+    }
+
+    static std::optional<InternedCourse> find(std::string_view code) {
+        const auto* entry = CourseTable<std::string>::instance().find(code);
+        if (!entry) return std::nullopt;
+        return InternedCourse(entry);
+    }
+
+    CourseId id() const { return entry->id; }
+    const std::string& str() const { return entry->code; }
+    operator const std::string&() const { return entry->code; }
+
+    bool operator==(const InternedCourse& other) const { return entry == other.entry; }
+    bool operator!=(const InternedCourse& other) const { return entry != other.entry; }
+    bool operator<(const InternedCourse& other) const {
+        return entry != other.entry && entry->code < other.entry->code;
+    }
+
+    friend std::ostream& operator<<(std::ostream& os, const InternedCourse& course) {
+        return os << course.entry->code;
+    }
+};
+
+// Key type a Student uses for course code C: string codes are interned,
+// every other code type is stored as-is.
+template<typename C>
+using CourseKey = std::conditional_t<std::is_same_v<C, std::string>, InternedCourse, C>;
+
+template<typename C>
+CourseId courseIdOf(const CourseKey<C>& key) {
+    if constexpr (std::is_same_v<CourseKey<C>, InternedCourse>) {
+        return key.id();
+    } else {
+        return CourseTable<C>::instance().intern(key)->id;
+    }
+}
+
+template<typename C>
+std::optional<CourseId> findCourseId(const C& code) {
+    const auto* entry = CourseTable<C>::instance().find(code);
+    if (!entry) return std::nullopt;
+    return entry->id;
+}
+
+#endif
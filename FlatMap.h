@@ -0,0 +1,208 @@
+#ifndef FLAT_MAP_H
+#define FLAT_MAP_H
+
+#include <algorithm>
+#include <cstddef>
+#include <new>
+#include <utility>
+
+// Sorted associative array stored in a single contiguous buffer. Up to
+// InlineCapacity entries live inside the object itself; beyond that the
+// entries move to the heap. Lookups are a linear scan for small sizes and a
+// binary search otherwise, iteration is in ascending key order like std::map.
+template<typename K, typename V, size_t InlineCapacity = 8>
+class FlatMap {
+public:
+    using key_type = K;
+    using mapped_type = V;
+    using value_type = std::pair<K, V>;
+    using iterator = value_type*;
+    using const_iterator = const value_type*;
+
+private:
+    static constexpr size_t linearSearchLimit = 16;
+
+    alignas(value_type) unsigned char inlineStorage[sizeof(value_type) * InlineCapacity];
+    value_type* items;
+    size_t used = 0;
+    size_t capacity = InlineCapacity;
+
+    value_type* inlineItems() {
+        return reinterpret_cast<value_type*>(inlineStorage);
+    }
+
+    bool isInline() const {
+        return items == reinterpret_cast<const value_type*>(inlineStorage);
+    }
+
+    void grow(size_t minimum) {
+        size_t newCapacity = std::max(minimum, capacity * 2);
+        value_type* fresh = static_cast<value_type*>(
+            ::operator new(newCapacity * sizeof(value_type)));
+        for (size_t i = 0; i < used; ++i) {
+            new (fresh + i) value_type(std::move(items[i]));
+            items[i].~value_type();
+        }
+        if (!isInline()) {
+            ::operator delete(items);
+        }
+        items = fresh;
+        capacity = newCapacity;
+    }
+
+    void release() {
+        clear();
+        if (!isInline()) {
+            ::operator delete(items);
+        }
+        items = inlineItems();
+        capacity = InlineCapacity;
+    }
+
+    void copyFrom(const FlatMap& other) {
+        if (other.used > capacity) grow(other.used);
+        for (size_t i = 0; i < other.used; ++i) {
+            new (items + i) value_type(other.items[i]);
+        }
+        used = other.used;
+    }
+
+    void moveFrom(FlatMap& other) {
+        if (!other.isInline()) {
+            items = other.items;
+            used = other.used;
+            capacity = other.capacity;
+            other.items = other.inlineItems();
+            other.used = 0;
+            other.capacity = InlineCapacity;
+            return;
+        }
+        for (size_t i = 0; i < other.used; ++i) {
+            new (items + i) value_type(std::move(other.items[i]));
+        }
+        used = other.used;
+        other.clear();
+    }
+
+    const_iterator lowerBound(const K& key) const {
+        if (used <= linearSearchLimit) {
+            const_iterator it = items;
+            while (it != items + used && it->first < key) ++it;
+            return it;
+        }
+        return std::lower_bound(items, items + used, key,
+                                [](const value_type& item, const K& k) { return item.first < k; });
+    }
+
+    iterator insertAt(const_iterator position, const K& key, const V& value) {
+        size_t index = static_cast<size_t>(position - items);
+        if (used == capacity) grow(used + 1);
+        if (index == used) {
+            new (items + used) value_type(key, value);
+        } else {
+            new (items + used) value_type(std::move(items[used - 1]));
+            for (size_t i = used - 1; i > index; --i) {
+                items[i] = std::move(items[i - 1]);
+            }
+            items[index] = value_type(key, value);
+        }
+        used++;
+        return items + index;
+    }
+
+public:
+    FlatMap() : items(inlineItems()) {}
+
+    FlatMap(const FlatMap& other) : items(inlineItems()) {
+        copyFrom(other);
+    }
+
+    FlatMap(FlatMap&& other) noexcept : items(inlineItems()) {
+        moveFrom(other);
+    }
+
+    FlatMap& operator=(const FlatMap& other) {
+        if (this != &other) {
+            clear();
+            copyFrom(other);
+        }
+        return *this;
+    }
+
+    FlatMap& operator=(FlatMap&& other) noexcept {
+        if (this != &other) {
+            release();
+            moveFrom(other);
+        }
+        return *this;
+    }
+
+    ~FlatMap() {
+        release();
+    }
+
+    iterator begin() { return items; }
+    iterator end() { return items + used; }
+    const_iterator begin() const { return items; }
+    const_iterator end() const { return items + used; }
+
+    size_t size() const { return used; }
+    bool empty() const { return used == 0; }
+
+    void clear() {
+        for (size_t i = 0; i < used; ++i) {
+            items[i].~value_type();
+        }
+        used = 0;
+    }
+
+    iterator find(const K& key) {
+        return const_cast<iterator>(static_cast<const FlatMap*>(this)->find(key));
+    }
+
+    const_iterator find(const K& key) const {
+        const_iterator it = lowerBound(key);
+        if (it != end() && !(key < it->first)) return it;
+        return end();
+    }
+
+    size_t count(const K& key) const {
+        return find(key) != end() ? 1 : 0;
+    }
+
+    V& operator[](const K& key) {
+        const_iterator it = lowerBound(key);
+        if (it != end() && !(key < it->first)) {
+            return const_cast<iterator>(it)->second;
+        }
+        return insertAt(it, key, V())->second;
+    }
+
+    std::pair<iterator, bool> insert_or_assign(const K& key, const V& value) {
+        const_iterator it = lowerBound(key);
+        if (it != end() && !(key < it->first)) {
+            const_cast<iterator>(it)->second = value;
+            return {const_cast<iterator>(it), false};
+        }
+        return {insertAt(it, key, value), true};
+    }
+
+    iterator erase(const_iterator position) {
+        size_t index = static_cast<size_t>(position - items);
+        for (size_t i = index; i + 1 < used; ++i) {
+            items[i] = std::move(items[i + 1]);
+        }
+        items[used - 1].~value_type();
+        used--;
+        return items + index;
+    }
+
+    size_t erase(const K& key) {
+        const_iterator it = find(key);
+        if (it == end()) return 0;
+        erase(it);
+        return 1;
+    }
+};
+
+#endif
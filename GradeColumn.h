@@ -0,0 +1,322 @@
+#ifndef GRADE_COLUMN_H
+#define GRADE_COLUMN_H
+
+#include "StudentArena.h"
+#include "RoaringBitmap.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <vector>
+
+struct GradeEntry {
+    double grade;
+    StudentHandle handle;
+};
+
+// The index stores grades in fixed point, as tenths of a point on the 0-10
+// scale, so grades that differ only by float noise (8.4 and 8.40000001)
+// share a bucket and a course's on-scale postings fit 101 fixed buckets.
+// Step t stands for the grade t / 10.0, which is exactly the double a
+// one-decimal grade parses to, so ">=" results on such grades are the same
+// as comparing the original doubles.
+using GradeTenths = uint16_t;
+
+struct GradeScale {
+    static constexpr GradeTenths maxTenths = 100;
+    static constexpr size_t steps = maxTenths + 1;
+
+    // The step a grade rounds to, or nullopt if it lies off the scale.
+    static std::optional<GradeTenths> toTenths(double grade) {
+        if (!(grade > -0.05 && grade < maxTenths / 10.0 + 0.05)) return std::nullopt;
+        long tenths = std::lround(grade * 10.0);
+        return static_cast<GradeTenths>(std::clamp<long>(tenths, 0, maxTenths));
+    }
+
+    static double toGrade(size_t tenths) {
+        return static_cast<double>(tenths) / 10.0;
+    }
+
+    // Smallest step whose grade is >= minGrade, or steps if there is none.
+    static size_t firstAtLeast(double minGrade) {
+        if (!(minGrade <= toGrade(maxTenths))) return steps;
+        if (minGrade <= 0.0) return 0;
+        size_t tenths = static_cast<size_t>(std::ceil(minGrade * 10.0));
+        while (tenths > 0 && toGrade(tenths - 1) >= minGrade) tenths--;
+        while (tenths < steps && toGrade(tenths) < minGrade) tenths++;
+        return tenths;
+    }
+};
+
+// The students holding one grade in a course. Postings versions share a
+// bucket's bitmap until a flush changes that bucket; generation is the
+// version that owns it and may edit it.
+struct GradeBucket {
+    double grade;
+    std::shared_ptr<RoaringBitmap> students;
+    uint64_t generation = 0;
+};
+
+// Postings of one course grouped into buckets by grade, highest grade
+// first, each holding its students as a compressed bitmap. A ">= threshold"
+// query is a prefix of the buckets, and iterating it yields postings by
+// grade (highest first), ties by handle. New postings are buffered and
+// added on the next flush. A flush publishes new postings instead of
+// editing the old ones, so readers holding a snapshot keep a consistent
+// view; only the buckets it changes are copied.
+class GradeColumn {
+public:
+    using Entries = std::vector<GradeEntry>;
+
+    struct Postings {
+        // Buckets for grades above the scale (exact values, rare), then one
+        // bucket per step from 10.0 down to 0.0 (possibly empty), then
+        // buckets for grades below the scale.
+        std::vector<GradeBucket> buckets;
+        size_t aboveCount = 0;
+        // prefixCounts[i] is the number of postings in buckets[0, i).
+        std::vector<size_t> prefixCounts;
+        // Sum of the posted grades: on-scale ones exactly, in tenths.
+        int64_t tenthsSum = 0;
+        double offScaleSum = 0.0;
+        // Buckets with this generation were created by this version.
+        uint64_t generation = 1;
+
+        Postings() {
+            static const auto empty = std::make_shared<RoaringBitmap>();
+            for (size_t step = GradeScale::steps; step-- > 0;) {
+                buckets.push_back(GradeBucket{GradeScale::toGrade(step), empty});
+            }
+            recount();
+        }
+
+        size_t size() const { return prefixCounts.back(); }
+
+        // Number of leading buckets with grade >= minGrade. On-scale
+        // thresholds are O(1); only off-scale ones search.
+        size_t bucketsAtLeast(double minGrade) const {
+            size_t first = GradeScale::firstAtLeast(minGrade);
+            if (first == GradeScale::steps) {
+                return countLeading(0, aboveCount, minGrade);
+            }
+            if (first > 0) {
+                return aboveCount + GradeScale::steps - first;
+            }
+            return countLeading(aboveCount + GradeScale::steps, buckets.size(), minGrade);
+        }
+
+        size_t countAtLeast(double minGrade) const {
+            return prefixCounts[bucketsAtLeast(minGrade)];
+        }
+
+        double mean() const {
+            if (size() == 0) return std::numeric_limits<double>::quiet_NaN();
+            return (static_cast<double>(tenthsSum) / 10.0 + offScaleSum) /
+                   static_cast<double>(size());
+        }
+
+        // Grade of the posting at index in column order (0 is the highest).
+        double gradeAt(size_t index) const {
+            auto it = std::upper_bound(prefixCounts.begin(), prefixCounts.end(), index);
+            return buckets[static_cast<size_t>(it - prefixCounts.begin()) - 1].grade;
+        }
+
+        // Nearest-rank percentile: the lowest posted grade with at least
+        // percent% of the postings at or below it (0 gives the minimum).
+        // NaN if there are no postings or percent is outside [0, 100].
+        double percentile(double percent) const {
+            size_t n = size();
+            if (n == 0 || !(percent >= 0.0 && percent <= 100.0)) {
+                return std::numeric_limits<double>::quiet_NaN();
+            }
+            size_t rank = static_cast<size_t>(std::ceil(percent * static_cast<double>(n) / 100.0));
+            return gradeAt(n - std::clamp<size_t>(rank, 1, n));
+        }
+
+        // Union of the students with grade >= minGrade.
+        RoaringBitmap studentsAtLeast(double minGrade) const {
+            std::vector<const RoaringBitmap*> parts;
+            size_t end = bucketsAtLeast(minGrade);
+            for (size_t b = 0; b < end; ++b) {
+                if (!buckets[b].students->empty()) parts.push_back(buckets[b].students.get());
+            }
+            return RoaringBitmap::unionOf(parts);
+        }
+
+        size_t memoryUsage() const {
+            size_t bytes = sizeof(Postings) + buckets.capacity() * sizeof(GradeBucket) +
+                           prefixCounts.capacity() * sizeof(size_t);
+            for (const GradeBucket& bucket : buckets) {
+                bytes += bucket.students->memoryUsage();
+            }
+            return bytes;
+        }
+
+        void recount() {
+            prefixCounts.assign(1, 0);
+            for (const GradeBucket& bucket : buckets) {
+                prefixCounts.push_back(prefixCounts.back() + bucket.students->cardinality());
+            }
+        }
+
+    private:
+        // Index just past the buckets in [first, last) with grade >= minGrade.
+        size_t countLeading(size_t first, size_t last, double minGrade) const {
+            auto end = std::partition_point(buckets.begin() + first, buckets.begin() + last,
+                                            [minGrade](const GradeBucket& bucket) {
+                                                return bucket.grade >= minGrade;
+                                            });
+            return static_cast<size_t>(end - buckets.begin());
+        }
+    };
+
+private:
+    struct Change {
+        GradeEntry entry;
+        bool added;
+    };
+
+    std::shared_ptr<const Postings> postings = std::make_shared<const Postings>();
+    std::vector<Change> pending;
+
+    static bool before(const GradeEntry& a, const GradeEntry& b) {
+        if (a.grade != b.grade) return a.grade > b.grade;
+        return a.handle < b.handle;
+    }
+
+    // The bucket's bitmap, copied first if an older version shares it.
+    static RoaringBitmap& writable(Postings& postings, GradeBucket& bucket) {
+        if (bucket.generation != postings.generation) {
+            bucket.students = std::make_shared<RoaringBitmap>(*bucket.students);
+            bucket.generation = postings.generation;
+        }
+        return *bucket.students;
+    }
+
+    // Off-scale grades get exact buckets, kept in order within their region.
+    static void insert(Postings& into, const GradeEntry& entry) {
+        auto& buckets = into.buckets;
+        if (auto tenths = GradeScale::toTenths(entry.grade)) {
+            size_t bucket = into.aboveCount + GradeScale::maxTenths - *tenths;
+            if (writable(into, buckets[bucket]).add(entry.handle)) into.tenthsSum += *tenths;
+            return;
+        }
+        bool above = entry.grade > 0.0;
+        auto first = buckets.begin() + (above ? 0 : into.aboveCount + GradeScale::steps);
+        auto last = above ? buckets.begin() + into.aboveCount : buckets.end();
+        auto it = std::partition_point(first, last, [&entry](const GradeBucket& bucket) {
+            return bucket.grade > entry.grade;
+        });
+        if (it == last || it->grade != entry.grade) {
+            it = buckets.insert(it, GradeBucket{entry.grade, std::make_shared<RoaringBitmap>(),
+                                                into.generation});
+            if (above) into.aboveCount++;
+        }
+        if (writable(into, *it).add(entry.handle)) into.offScaleSum += entry.grade;
+    }
+
+    // Fixed buckets stay even when empty; an emptied off-scale bucket goes.
+    static void erase(Postings& from, const GradeEntry& entry) {
+        auto& buckets = from.buckets;
+        if (auto tenths = GradeScale::toTenths(entry.grade)) {
+            size_t bucket = from.aboveCount + GradeScale::maxTenths - *tenths;
+            if (buckets[bucket].students->contains(entry.handle) &&
+                writable(from, buckets[bucket]).remove(entry.handle)) {
+                from.tenthsSum -= *tenths;
+            }
+            return;
+        }
+        bool above = entry.grade > 0.0;
+        auto first = buckets.begin() + (above ? 0 : from.aboveCount + GradeScale::steps);
+        auto last = above ? buckets.begin() + from.aboveCount : buckets.end();
+        auto it = std::partition_point(first, last, [&entry](const GradeBucket& bucket) {
+            return bucket.grade > entry.grade;
+        });
+        if (it == last || it->grade != entry.grade || !it->students->contains(entry.handle) ||
+            !writable(from, *it).remove(entry.handle)) {
+            return;
+        }
+        from.offScaleSum -= entry.grade;
+        if (it->students->empty()) {
+            buckets.erase(it);
+            if (above) from.aboveCount--;
+        }
+    }
+
+public:
+    // Posts handle under grade; on-scale grades are rounded to 0.1.
+    void add(double grade, StudentHandle handle) {
+        pending.push_back(Change{GradeEntry{grade, handle}, true});
+    }
+
+    // Withdraws a posting made with add(grade, handle). Pending additions
+    // and removals are applied in the order they were made, so a handle can
+    // be withdrawn and posted again under a new grade before the next flush.
+    void remove(double grade, StudentHandle handle) {
+        pending.push_back(Change{GradeEntry{grade, handle}, false});
+    }
+
+    // True if entries are in column order (grade descending, then handle
+    // ascending, no duplicates), as build() requires.
+    static bool inColumnOrder(const Entries& entries) {
+        return std::adjacent_find(entries.begin(), entries.end(),
+                                  [](const GradeEntry& a, const GradeEntry& b) {
+                                      return !before(a, b);
+                                  }) == entries.end();
+    }
+
+    // Builds postings from entries already in column order, e.g. read back
+    // from a snapshot.
+    static std::shared_ptr<const Postings> build(const Entries& sorted) {
+        auto built = std::make_shared<Postings>();
+        for (const GradeEntry& entry : sorted) {
+            insert(*built, entry);
+        }
+        for (GradeBucket& bucket : built->buckets) {
+            if (bucket.generation == built->generation) bucket.students->shrinkToFit();
+        }
+        built->recount();
+        return built;
+    }
+
+    // Replaces the column with built postings.
+    void assign(std::shared_ptr<const Postings> built) {
+        pending.clear();
+        postings = std::move(built);
+    }
+
+    bool hasPending() const {
+        return !pending.empty();
+    }
+
+    // Buckets are found by step, so pending postings need no sorting; they
+    // usually arrive in handle order, which keeps bitmap inserts appends.
+    // The new version shares every bucket it does not change with the old
+    // one, so a flush costs the changed buckets, not the whole column.
+    void flush() {
+        if (!hasPending()) return;
+        
+        auto updated = std::make_shared<Postings>(*postings);
+        updated->generation = postings->generation + 1;
+        for (const Change& change : pending) {
+            if (change.added) {
+                insert(*updated, change.entry);
+            } else {
+                erase(*updated, change.entry);
+            }
+        }
+        updated->recount();
+        pending.clear();
+        postings = std::move(updated);
+    }
+
+    const std::shared_ptr<const Postings>& snapshot() const {
+        return postings;
+    }
+
+    size_t size() const { return postings->size(); }
+};
+
+#endif
@@ -0,0 +1,93 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <algorithm>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+class MappedFile {
+private:
+    void* data = nullptr;
+    size_t length = 0;
+    bool opened = false;
+
+    void release() {
+        if (data != nullptr) {
+            munmap(data, length);
+        }
+        data = nullptr;
+        length = 0;
+        opened = false;
+    }
+
+public:
+    explicit MappedFile(const std::string& filename) {
+        int fd = open(filename.c_str(), O_RDONLY);
+        if (fd < 0) return;
+        
+        struct stat info;
+        if (fstat(fd, &info) == 0) {
+            length = static_cast<size_t>(info.st_size);
+            if (length == 0) {
+                opened = true;
+            } else {
+                void* mapped = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (mapped != MAP_FAILED) {
+                    data = mapped;
+                    opened = true;
+                    madvise(data, length, MADV_SEQUENTIAL);
+                } else {
+                    length = 0;
+                }
+            }
+        }
+        close(fd);
+    }
+
+    ~MappedFile() {
+        release();
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    MappedFile(MappedFile&& other) noexcept
+        : data(std::exchange(other.data, nullptr)),
+          length(std::exchange(other.length, 0)),
+          opened(std::exchange(other.opened, false)) {}
+
+    MappedFile& operator=(MappedFile&& other) noexcept {
+        if (this != &other) {
+            release();
+            data = std::exchange(other.data, nullptr);
+            length = std::exchange(other.length, 0);
+            opened = std::exchange(other.opened, false);
+        }
+        return *this;
+    }
+
+    bool isOpen() const { return opened; }
+    size_t size() const { return length; }
+
+    // Drops the mapped pages that lie entirely before offset from memory. They
+    // are read back from the file if touched again, so a sequential reader
+    // can keep its resident set bounded.
+    void discardBefore(size_t offset) {
+        size_t pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        size_t end = std::min(offset, length) / pageSize * pageSize;
+        if (data != nullptr && end > 0) {
+            madvise(data, end, MADV_DONTNEED);
+        }
+    }
+
+    std::string_view view() const {
+        return std::string_view(static_cast<const char*>(data), length);
+    }
+};
+
+#endif
@@ -0,0 +1,393 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+
+// Process-wide counters and latency histograms for the registry and the CSV
+// reader. Recording is a few relaxed atomic adds. Building with
+// -DERP_DISABLE_METRICS (make DISABLE_METRICS=1) turns every recording call
+// into a no-op and drops the clock reads that feed them.
+#ifdef ERP_DISABLE_METRICS
+inline constexpr bool metricsEnabled = false;
+#else
+inline constexpr bool metricsEnabled = true;
+#endif
+
+struct LatencySummary {
+    uint64_t count = 0;
+    double meanMicros = 0.0;
+    double p50Micros = 0.0;
+    double p90Micros = 0.0;
+    double p99Micros = 0.0;
+    double maxMicros = 0.0;
+};
+
+// Latency histogram in nanoseconds with 8 buckets per power of two. A
+// reported percentile is the upper edge of its bucket (capped at the max),
+// at most 12.5% above the true value.
+class LatencyHistogram {
+private:
+    static constexpr unsigned subBits = 3;
+    static constexpr size_t subBuckets = size_t(1) << subBits;
+    static constexpr size_t bucketCount = (64 - subBits + 1) * subBuckets;
+
+    std::array<std::atomic<uint64_t>, bucketCount> buckets{};
+    std::atomic<uint64_t> samples{0};
+    std::atomic<uint64_t> totalNanos{0};
+    std::atomic<uint64_t> maxNanos{0};
+
+    static size_t bucketOf(uint64_t nanos) {
+        if (nanos < subBuckets) return static_cast<size_t>(nanos);
+        unsigned msb = 63 - static_cast<unsigned>(__builtin_clzll(nanos));
+        size_t sub = static_cast<size_t>(nanos >> (msb - subBits)) & (subBuckets - 1);
+        return (msb - subBits + 1) * subBuckets + sub;
+    }
+
+    static uint64_t upperEdge(size_t bucket) {
+        if (bucket < subBuckets) return bucket;
+        unsigned shift = static_cast<unsigned>(bucket / subBuckets) - 1;
+        uint64_t lower = (subBuckets + bucket % subBuckets) << shift;
+        return lower + (uint64_t(1) << shift) - 1;
+    }
+
+public:
+    void record(uint64_t nanos) {
+        buckets[bucketOf(nanos)].fetch_add(1, std::memory_order_relaxed);
+        samples.fetch_add(1, std::memory_order_relaxed);
+        totalNanos.fetch_add(nanos, std::memory_order_relaxed);
+        uint64_t seen = maxNanos.load(std::memory_order_relaxed);
+        while (nanos > seen &&
+               !maxNanos.compare_exchange_weak(seen, nanos, std::memory_order_relaxed)) {
+        }
+    }
+
+    void record(std::chrono::nanoseconds elapsed) {
+        record(static_cast<uint64_t>(std::max<int64_t>(0, elapsed.count())));
+    }
+
+    LatencySummary summary() const {
+        std::array<uint64_t, bucketCount> counts;
+        uint64_t count = 0;
+        for (size_t b = 0; b < bucketCount; ++b) {
+            counts[b] = buckets[b].load(std::memory_order_relaxed);
+            count += counts[b];
+        }
+        LatencySummary result;
+        result.count = count;
+        if (count == 0) return result;
+        uint64_t largest = maxNanos.load(std::memory_order_relaxed);
+        auto percentile = [&](double percent) {
+            uint64_t rank = std::max<uint64_t>(
+                1, static_cast<uint64_t>(percent / 100.0 * static_cast<double>(count) + 0.5));
+            uint64_t seen = 0;
+            for (size_t b = 0; b < bucketCount; ++b) {
+                seen += counts[b];
+                if (seen >= rank) return std::min(upperEdge(b), largest) / 1000.0;
+            }
+            return largest / 1000.0;
+        };
+        result.meanMicros = totalNanos.load(std::memory_order_relaxed) / 1000.0 /
+                            static_cast<double>(std::max<uint64_t>(1, samples.load()));
+        result.p50Micros = percentile(50.0);
+        result.p90Micros = percentile(90.0);
+        result.p99Micros = percentile(99.0);
+        result.maxMicros = largest / 1000.0;
+        return result;
+    }
+
+    void reset() {
+        for (auto& bucket : buckets) {
+            bucket.store(0, std::memory_order_relaxed);
+        }
+        samples.store(0, std::memory_order_relaxed);
+        totalNanos.store(0, std::memory_order_relaxed);
+        maxNanos.store(0, std::memory_order_relaxed);
+    }
+};
+
+// Plain copy of every metric at one moment, with text and JSON renderings.
+struct MetricsSnapshot {
+    bool enabled = metricsEnabled;
+    uint64_t rowsParsed = 0;
+    uint64_t rowsRejected = 0;
+    uint64_t entriesRejected = 0;
+    uint64_t bytesParsed = 0;
+    double parseSeconds = 0.0;
+    double parseMBPerSecond = 0.0;
+    uint64_t lockAcquisitions = 0;
+    uint64_t lockContended = 0;
+    double lockWaitSeconds = 0.0;
+    LatencySummary lockWait;
+    LatencySummary gradeRange;
+    LatencySummary gradeQuery;
+    LatencySummary multiGradeQuery;
+    LatencySummary sortTotal;
+    LatencySummary sortChunkPhase;
+    LatencySummary sortMergePhase;
+
+    std::string toText() const {
+        std::ostringstream out;
+        out << std::fixed << std::setprecision(3)
+            << "metrics.enabled " << enabled << "\n"
+            << "csv.rows_parsed " << rowsParsed << "\n"
+            << "csv.rows_rejected " << rowsRejected << "\n"
+            << "csv.entries_rejected " << entriesRejected << "\n"
+            << "csv.bytes_parsed " << bytesParsed << "\n"
+            << "csv.parse_seconds " << std::setprecision(6) << parseSeconds
+            << std::setprecision(3) << "\n"
+            << "csv.parse_mb_per_second " << parseMBPerSecond << "\n"
+            << "registry.lock_acquisitions " << lockAcquisitions << "\n"
+            << "registry.lock_contended " << lockContended << "\n"
+            << "registry.lock_wait_seconds " << std::setprecision(6)
+            << lockWaitSeconds << std::setprecision(3) << "\n";
+        auto latency = [&out](const char* name, const LatencySummary& summary) {
+            out << name << ".count " << summary.count << "\n"
+                << name << ".mean_us " << summary.meanMicros << "\n"
+                << name << ".p50_us " << summary.p50Micros << "\n"
+                << name << ".p90_us " << summary.p90Micros << "\n"
+                << name << ".p99_us " << summary.p99Micros << "\n"
+                << name << ".max_us " << summary.maxMicros << "\n";
+        };
+        latency("registry.lock_wait", lockWait);
+        latency("query.grade_range", gradeRange);
+        latency("query.students_with_grade", gradeQuery);
+        latency("query.match_grades", multiGradeQuery);
+        latency("sort.total", sortTotal);
+        latency("sort.chunk_phase", sortChunkPhase);
+        latency("sort.merge_phase", sortMergePhase);
+        return out.str();
+    }
+
+    std::string toJson() const {
+        std::ostringstream out;
+        out << std::fixed << std::setprecision(3)
+            << "{\"enabled\":" << (enabled ? "true" : "false")
+            << ",\"csv\":{\"rows_parsed\":" << rowsParsed
+            << ",\"rows_rejected\":" << rowsRejected
+            << ",\"entries_rejected\":" << entriesRejected
+            << ",\"bytes_parsed\":" << bytesParsed
+            << ",\"parse_seconds\":" << std::setprecision(6) << parseSeconds
+            << std::setprecision(3)
+            << ",\"parse_mb_per_second\":" << parseMBPerSecond << "}"
+            << ",\"registry\":{\"lock_acquisitions\":" << lockAcquisitions
+            << ",\"lock_contended\":" << lockContended
+            << ",\"lock_wait_seconds\":" << std::setprecision(6) << lockWaitSeconds
+            << std::setprecision(3) << "}";
+        auto latency = [&out](const char* name, const LatencySummary& summary) {
+            out << ",\"" << name << "\":{\"count\":" << summary.count
+                << ",\"mean_us\":" << summary.meanMicros
+                << ",\"p50_us\":" << summary.p50Micros
+                << ",\"p90_us\":" << summary.p90Micros
+                << ",\"p99_us\":" << summary.p99Micros
+                << ",\"max_us\":" << summary.maxMicros << "}";
+        };
+        latency("lock_wait", lockWait);
+        latency("grade_range", gradeRange);
+        latency("students_with_grade", gradeQuery);
+        latency("match_grades", multiGradeQuery);
+        latency("sort_total", sortTotal);
+        latency("sort_chunk_phase", sortChunkPhase);
+        latency("sort_merge_phase", sortMergePhase);
+        out << "}\n";
+        return out.str();
+    }
+};
+
+class Metrics {
+private:
+    using Clock = std::chrono::steady_clock;
+
+    std::atomic<uint64_t> rowsParsed{0};
+    std::atomic<uint64_t> rowsRejected{0};
+    std::atomic<uint64_t> entriesRejected{0};
+    std::atomic<uint64_t> bytesParsed{0};
+    std::atomic<uint64_t> parseNanos{0};
+    std::atomic<uint64_t> lockAcquisitions{0};
+    LatencyHistogram lockWait;
+    LatencyHistogram gradeRange;
+    LatencyHistogram gradeQuery;
+    LatencyHistogram multiGradeQuery;
+    LatencyHistogram sortTotal;
+    LatencyHistogram sortChunkPhase;
+    LatencyHistogram sortMergePhase;
+
+    Metrics() = default;
+
+public:
+    Metrics(const Metrics&) = delete;
+    Metrics& operator=(const Metrics&) = delete;
+
+    static Metrics& instance() {
+        static Metrics metrics;
+        return metrics;
+    }
+
+    // Measures from construction to destruction into a histogram.
+    class ScopedTimer {
+        LatencyHistogram* histogram = nullptr;
+        Clock::time_point start;
+
+    public:
+        explicit ScopedTimer(LatencyHistogram& target) {
+            if constexpr (metricsEnabled) {
+                histogram = &target;
+                start = Clock::now();
+            }
+        }
+
+        ScopedTimer(const ScopedTimer&) = delete;
+        ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+        ~ScopedTimer() {
+            if constexpr (metricsEnabled) {
+                histogram->record(Clock::now() - start);
+            }
+        }
+    };
+
+    // Locks mutex with Lock (std::unique_lock or std::shared_lock). Only a
+    // contended acquisition reads the clock to time its wait.
+    template<typename Lock, typename Mutex>
+    static Lock acquire(Mutex& mutex) {
+        if constexpr (!metricsEnabled) {
+            return Lock(mutex);
+        } else {
+            Metrics& metrics = instance();
+            metrics.lockAcquisitions.fetch_add(1, std::memory_order_relaxed);
+            Lock lock(mutex, std::try_to_lock);
+            if (!lock.owns_lock()) {
+                auto start = Clock::now();
+                lock.lock();
+                metrics.lockWait.record(Clock::now() - start);
+            }
+            return lock;
+        }
+    }
+
+    void recordParse(uint64_t rows, uint64_t rejectedRows, uint64_t rejectedEntries,
+                     uint64_t bytes, std::chrono::nanoseconds elapsed) {
+        if constexpr (metricsEnabled) {
+            rowsParsed.fetch_add(rows, std::memory_order_relaxed);
+            rowsRejected.fetch_add(rejectedRows, std::memory_order_relaxed);
+            entriesRejected.fetch_add(rejectedEntries, std::memory_order_relaxed);
+            bytesParsed.fetch_add(bytes, std::memory_order_relaxed);
+            parseNanos.fetch_add(static_cast<uint64_t>(elapsed.count()),
+                                 std::memory_order_relaxed);
+        }
+    }
+
+    void recordSort(std::chrono::microseconds total, std::chrono::microseconds chunkPhase,
+                    std::chrono::microseconds mergePhase) {
+        if constexpr (metricsEnabled) {
+            sortTotal.record(total);
+            sortChunkPhase.record(chunkPhase);
+            sortMergePhase.record(mergePhase);
+        }
+    }
+
+    // gradeRanges times StudentRegistry::gradeRange, the snapshot and bucket
+    // lookup every grade query starts with; gradeQueries times whole grade
+    // queries, including collecting their students.
+    LatencyHistogram& gradeRanges() { return gradeRange; }
+    LatencyHistogram& gradeQueries() { return gradeQuery; }
+    LatencyHistogram& multiGradeQueries() { return multiGradeQuery; }
+
+    MetricsSnapshot snapshot() const {
+        MetricsSnapshot result;
+        result.rowsParsed = rowsParsed.load(std::memory_order_relaxed);
+        result.rowsRejected = rowsRejected.load(std::memory_order_relaxed);
+        result.entriesRejected = entriesRejected.load(std::memory_order_relaxed);
+        result.bytesParsed = bytesParsed.load(std::memory_order_relaxed);
+        result.parseSeconds = parseNanos.load(std::memory_order_relaxed) / 1e9;
+        if (result.parseSeconds > 0.0) {
+            result.parseMBPerSecond = result.bytesParsed / 1e6 / result.parseSeconds;
+        }
+        result.lockAcquisitions = lockAcquisitions.load(std::memory_order_relaxed);
+        result.lockWait = lockWait.summary();
+        result.lockContended = result.lockWait.count;
+        result.lockWaitSeconds = result.lockWait.meanMicros * result.lockWait.count / 1e6;
+        result.gradeRange = gradeRange.summary();
+        result.gradeQuery = gradeQuery.summary();
+        result.multiGradeQuery = multiGradeQuery.summary();
+        result.sortTotal = sortTotal.summary();
+        result.sortChunkPhase = sortChunkPhase.summary();
+        result.sortMergePhase = sortMergePhase.summary();
+        return result;
+    }
+
+    void reset() {
+        for (auto* counter : {&rowsParsed, &rowsRejected, &entriesRejected, &bytesParsed,
+                              &parseNanos, &lockAcquisitions}) {
+            counter->store(0, std::memory_order_relaxed);
+        }
+        for (auto* histogram : {&lockWait, &gradeRange, &gradeQuery, &multiGradeQuery,
+                                &sortTotal, &sortChunkPhase, &sortMergePhase}) {
+            histogram->reset();
+        }
+    }
+
+    // Writes a snapshot to filename, as JSON if it ends in ".json" and as
+    // "name value" lines otherwise. The file is replaced atomically, so a
+    // scraper never reads a partial one. Returns false on failure.
+    bool writeTo(const std::string& filename) const {
+        bool json = filename.size() >= 5 && filename.compare(filename.size() - 5, 5, ".json") == 0;
+        MetricsSnapshot current = snapshot();
+        std::string temp = filename + ".tmp";
+        {
+            std::ofstream out(temp, std::ios::trunc);
+            out << (json ? current.toJson() : current.toText());
+            if (!out) return false;
+        }
+        return std::rename(temp.c_str(), filename.c_str()) == 0;
+    }
+};
+
+// Writes Metrics::instance() to a file every interval from a background
+// thread, and once more when destroyed.
+class MetricsDumper {
+private:
+    std::string filename;
+    std::chrono::milliseconds interval;
+    std::mutex stopMutex;
+    std::condition_variable stopSignal;
+    bool stopping = false;
+    std::thread worker;
+
+public:
+    MetricsDumper(std::string filename, std::chrono::milliseconds interval)
+        : filename(std::move(filename)), interval(interval) {
+        worker = std::thread([this]() {
+            std::unique_lock<std::mutex> lock(stopMutex);
+            while (!stopSignal.wait_for(lock, this->interval, [this]() { return stopping; })) {
+                Metrics::instance().writeTo(this->filename);
+            }
+        });
+    }
+
+    MetricsDumper(const MetricsDumper&) = delete;
+    MetricsDumper& operator=(const MetricsDumper&) = delete;
+
+    ~MetricsDumper() {
+        {
+            std::lock_guard<std::mutex> lock(stopMutex);
+            stopping = true;
+        }
+        stopSignal.notify_one();
+        worker.join();
+        Metrics::instance().writeTo(filename);
+    }
+};
+
+#endif
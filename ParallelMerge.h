@@ -0,0 +1,119 @@
+#ifndef PARALLEL_MERGE_H
+#define PARALLEL_MERGE_H
+
+#include "ThreadPool.h"
+#include <algorithm>
+#include <chrono>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+// Number of elements of a that land in the first `rank` outputs of a stable
+// merge of sorted ranges a and b (ties taken from a first). The output split
+// at `rank` is then a[0, j) + b[0, rank - j). Merge-path binary search,
+// O(log min(aSize, bSize)).
+template<typename It, typename Compare>
+size_t coRank(size_t rank, It a, size_t aSize, It b, size_t bSize, Compare less) {
+    size_t lo = rank > bSize ? rank - bSize : 0;
+    size_t hi = std::min(rank, aSize);
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (!less(b[rank - mid - 1], a[mid])) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+// Moves the stable merge of sorted ranges a and b to out. The output is cut
+// into `pieces` equal slices at co-ranked split points and each slice is
+// merged by its own task in group; the caller waits on the group.
+template<typename It, typename OutIt, typename Compare>
+void parallelMerge(It a, size_t aSize, It b, size_t bSize, OutIt out, size_t pieces,
+                   Compare less, TaskGroup& group) {
+    size_t total = aSize + bSize;
+    pieces = std::max<size_t>(1, std::min(pieces, total));
+    // All split points are found before any piece starts moving elements.
+    std::vector<size_t> splits(pieces + 1, 0);
+    for (size_t piece = 1; piece <= pieces; ++piece) {
+        splits[piece] = coRank(total * piece / pieces, a, aSize, b, bSize, less);
+    }
+    for (size_t piece = 0; piece < pieces; ++piece) {
+        size_t rank = total * piece / pieces;
+        size_t nextRank = total * (piece + 1) / pieces;
+        size_t split = splits[piece];
+        size_t nextSplit = splits[piece + 1];
+        auto mergePiece = [=]() {
+            std::merge(std::make_move_iterator(a + split),
+                       std::make_move_iterator(a + nextSplit),
+                       std::make_move_iterator(b + (rank - split)),
+                       std::make_move_iterator(b + (nextRank - nextSplit)),
+                       out + rank, less);
+        };
+        if (piece + 1 == pieces) {
+            mergePiece();
+        } else {
+            group.run(mergePiece);
+        }
+    }
+}
+
+// Recursive step of parallelMergeSort: sorts [begin, end) of data as `leaves`
+// chunks and leaves the result in buffer if intoBuffer, otherwise in data.
+// Halves are sorted into the other vector so each level merges once.
+template<typename T, typename Compare>
+void mergeSortRange(std::vector<T>& data, std::vector<T>& buffer, size_t begin, size_t end,
+                    size_t firstLeaf, size_t leaves, bool intoBuffer, Compare less,
+                    std::vector<std::chrono::microseconds>& leafTimes, ThreadPool& pool) {
+    if (leaves == 1) {
+        auto startTime = std::chrono::high_resolution_clock::now();
+        std::sort(data.begin() + begin, data.begin() + end, less);
+        if (intoBuffer) {
+            std::move(data.begin() + begin, data.begin() + end, buffer.begin() + begin);
+        }
+        auto endTime = std::chrono::high_resolution_clock::now();
+        leafTimes[firstLeaf] =
+            std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime);
+        return;
+    }
+    
+    size_t leftLeaves = leaves / 2;
+    size_t mid = begin + (end - begin) * leftLeaves / leaves;
+    {
+        TaskGroup group(pool);
+        group.run([&, begin, mid, firstLeaf, leftLeaves, intoBuffer]() {
+            mergeSortRange(data, buffer, begin, mid, firstLeaf, leftLeaves, !intoBuffer,
+                           less, leafTimes, pool);
+        });
+        mergeSortRange(data, buffer, mid, end, firstLeaf + leftLeaves, leaves - leftLeaves,
+                       !intoBuffer, less, leafTimes, pool);
+        group.wait();
+    }
+    
+    std::vector<T>& source = intoBuffer ? data : buffer;
+    std::vector<T>& target = intoBuffer ? buffer : data;
+    TaskGroup group(pool);
+    parallelMerge(source.begin() + begin, mid - begin, source.begin() + mid, end - mid,
+                  target.begin() + begin, leaves, less, group);
+    group.wait();
+}
+
+// Sorts data with a recursive task-parallel merge sort on pool: the range is
+// split into `leaves` chunks that are sorted with std::sort, and each pair of
+// sibling halves is merged with parallelMerge as soon as both are sorted.
+// Elements are moved, never copied. leafTimes receives each chunk's sort time.
+template<typename T, typename Compare>
+void parallelMergeSort(std::vector<T>& data, size_t leaves, Compare less,
+                       std::vector<std::chrono::microseconds>& leafTimes,
+                       ThreadPool& pool = ThreadPool::instance()) {
+    leaves = std::max<size_t>(1, std::min(leaves, data.size()));
+    leafTimes.assign(leaves, std::chrono::microseconds(0));
+    if (data.empty()) return;
+    
+    std::vector<T> buffer(leaves > 1 ? data.size() : 0);
+    mergeSortRange(data, buffer, 0, data.size(), 0, leaves, false, less, leafTimes, pool);
+}
+
+#endif
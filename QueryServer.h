@@ -0,0 +1,396 @@
+#ifndef QUERY_SERVER_H
+#define QUERY_SERVER_H
+
+#include "StudentDataset.h"
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+// Serves a StudentDataset over a Unix domain socket from one epoll event
+// loop. The protocol is line based and pipelined: a client may send any
+// number of requests without waiting, and gets exactly one response line
+// per request, in order. Every request line that arrives in one read is
+// answered against the same loaded data, and the responses are written back
+// with as few writes as the socket accepts. When the file changes on disk it
+// is reloaded on a background thread, and requests keep being answered from
+// the old data until the new data is ready.
+//
+//   PING                                  OK
+//   GRADE <course> <minGrade> [limit]     OK <count> <roll>...
+//   ROLL <rollNumber>                     OK <roll> <year> <branch> <name>
+//                                         or NONE
+//   RANGE <fromRoll> <toRoll> [limit]     OK <count> <roll>...
+//   QUIT                                  OK, then the server closes
+//
+// GRADE lists the students with grade >= minGrade in course, highest grade
+// first; RANGE lists roll numbers from fromRoll to toRoll inclusive in
+// sorted order. count is the full number of matches and at most limit roll
+// numbers follow it. A malformed request gets "ERR <reason>".
+class QueryServer {
+public:
+    using Dataset = StudentDataset<std::string, std::string>;
+
+private:
+    struct Connection {
+        std::string input;
+        std::string output;
+        size_t written = 0;
+        uint32_t events = 0;
+        bool quit = false;
+        bool peerClosed = false;
+
+        bool hasCompleteLine() const {
+            return input.find('\n') != std::string::npos;
+        }
+
+        size_t pending() const {
+            return output.size() - written;
+        }
+    };
+
+    // Past this much unsent output a connection stops reading, so a client
+    // that pipelines without reading cannot grow the buffer without bound.
+    static constexpr size_t outputLimit = 1 << 20;
+    static constexpr size_t maxLineLength = 1 << 16;
+    static constexpr int maxEvents = 64;
+
+    Dataset& dataset;
+    std::string socketPath;
+    int listenFd = -1;
+    int epollFd = -1;
+    int stopFd = -1;
+    std::unordered_map<int, Connection> connections;
+
+    static std::vector<std::string_view> splitWords(std::string_view line) {
+        std::vector<std::string_view> words;
+        size_t pos = 0;
+        while (true) {
+            pos = line.find_first_not_of(" \t\r", pos);
+            if (pos == std::string_view::npos) break;
+            size_t end = std::min(line.find_first_of(" \t\r", pos), line.size());
+            words.push_back(line.substr(pos, end - pos));
+            pos = end;
+        }
+        return words;
+    }
+
+    static bool parseLimit(std::string_view text, size_t& limit) {
+        auto result = std::from_chars(text.data(), text.data() + text.size(), limit);
+        return result.ec == std::errc() && result.ptr == text.data() + text.size();
+    }
+
+    bool watch(int fd, uint32_t events, int op) {
+        epoll_event event{};
+        event.events = events;
+        event.data.fd = fd;
+        return epoll_ctl(epollFd, op, fd, &event) == 0;
+    }
+
+    void closeConnection(int fd) {
+        epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, nullptr);
+        close(fd);
+        connections.erase(fd);
+    }
+
+    void acceptConnections() {
+        while (true) {
+            int fd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (fd < 0) return;
+            Connection& connection = connections[fd];
+            connection.events = EPOLLIN;
+            if (!watch(fd, connection.events, EPOLL_CTL_ADD)) {
+                closeConnection(fd);
+            }
+        }
+    }
+
+    // Answers the complete lines buffered on connection until its unsent
+    // output reaches outputLimit or a QUIT is seen.
+    void answerLines(Connection& connection) {
+        size_t start = 0;
+        std::shared_ptr<const Dataset::Data> data;
+        while (!connection.quit && connection.pending() < outputLimit) {
+            size_t end = connection.input.find('\n', start);
+            if (end == std::string::npos) break;
+            if (!data) data = dataset.current();
+            std::string_view line(connection.input.data() + start, end - start);
+            start = end + 1;
+            if (!data) {
+                connection.output += "ERR no data loaded\n";
+            } else if (answer(*data, line, connection.output)) {
+                connection.quit = true;
+            }
+        }
+        connection.input.erase(0, start);
+        if (!connection.quit && connection.input.size() > maxLineLength &&
+            !connection.hasCompleteLine()) {
+            connection.output += "ERR line too long\n";
+            connection.quit = true;
+        }
+    }
+
+    // Sends what it can of connection's output and updates the events it
+    // waits for. Returns false once the connection is finished with: on a
+    // send error, or when everything owed to it has been sent after a QUIT
+    // or after the peer shut down its side.
+    bool flush(int fd, Connection& connection) {
+        while (connection.pending() > 0) {
+            ssize_t sent = send(fd, connection.output.data() + connection.written,
+                                connection.pending(), MSG_NOSIGNAL);
+            if (sent < 0) {
+                if (errno == EINTR) continue;
+                if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+                return false;
+            }
+            connection.written += static_cast<size_t>(sent);
+        }
+        if (connection.pending() == 0) {
+            connection.output.clear();
+            connection.written = 0;
+            if (connection.quit ||
+                (connection.peerClosed && !connection.hasCompleteLine())) {
+                return false;
+            }
+        } else if (connection.written > outputLimit) {
+            connection.output.erase(0, connection.written);
+            connection.written = 0;
+        }
+
+        uint32_t events = 0;
+        if (!connection.quit && !connection.peerClosed && connection.pending() < outputLimit) {
+            events |= EPOLLIN;
+        }
+        if (connection.pending() > 0) {
+            events |= EPOLLOUT;
+        }
+        if (events != connection.events) {
+            connection.events = events;
+            if (!watch(fd, events, EPOLL_CTL_MOD)) return false;
+        }
+        return true;
+    }
+
+    void serviceConnection(int fd, uint32_t events) {
+        auto found = connections.find(fd);
+        if (found == connections.end()) return;
+        Connection& connection = found->second;
+        if (events & EPOLLERR) {
+            closeConnection(fd);
+            return;
+        }
+        // A hangup can arrive while input is not watched (output over
+        // outputLimit). It is read like input: requests still buffered are
+        // answered, the end of input sets peerClosed, and the answers owed
+        // are flushed until the output is empty or a send fails.
+        if (events & (EPOLLIN | EPOLLHUP)) {
+            char buffer[65536];
+            while (connection.input.size() <= outputLimit) {
+                ssize_t received = recv(fd, buffer, sizeof(buffer), 0);
+                if (received > 0) {
+                    connection.input.append(buffer, static_cast<size_t>(received));
+                    continue;
+                }
+                if (received < 0 && errno == EINTR) continue;
+                if (received < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
+                    closeConnection(fd);
+                    return;
+                }
+                // A peer that shut down its side still gets answers to what
+                // it sent.
+                connection.peerClosed = received == 0;
+                break;
+            }
+        }
+        // Lines left over when the output limit was hit are answered as soon
+        // as the output drains, without waiting for more input.
+        while (true) {
+            answerLines(connection);
+            if (!flush(fd, connection)) {
+                closeConnection(fd);
+                return;
+            }
+            if (connection.pending() > 0 || connection.quit || !connection.hasCompleteLine()) {
+                break;
+            }
+        }
+    }
+
+public:
+    QueryServer(Dataset& dataset, std::string socketPath)
+        : dataset(dataset), socketPath(std::move(socketPath)) {}
+
+    QueryServer(const QueryServer&) = delete;
+    QueryServer& operator=(const QueryServer&) = delete;
+
+    ~QueryServer() {
+        for (const auto& entry : connections) {
+            close(entry.first);
+        }
+        if (listenFd >= 0) {
+            close(listenFd);
+            unlink(socketPath.c_str());
+        }
+        if (epollFd >= 0) close(epollFd);
+        if (stopFd >= 0) close(stopFd);
+    }
+
+    // Appends the response to one request line to out. Returns true if the
+    // request was QUIT.
+    static bool answer(const Dataset::Data& data, std::string_view line, std::string& out) {
+        auto words = splitWords(line);
+        if (words.empty()) {
+            out += "ERR empty request\n";
+            return false;
+        }
+        std::string_view command = words[0];
+        size_t limit = SIZE_MAX;
+        if (command == "PING" && words.size() == 1) {
+            out += "OK\n";
+        } else if (command == "QUIT" && words.size() == 1) {
+            out += "OK\n";
+            return true;
+        } else if (command == "GRADE" && (words.size() == 3 || words.size() == 4)) {
+            std::string grade(words[2]);
+            char* end = nullptr;
+            double minGrade = std::strtod(grade.c_str(), &end);
+            if (end != grade.c_str() + grade.size() || std::isnan(minGrade) ||
+                (words.size() == 4 && !parseLimit(words[3], limit))) {
+                out += "ERR usage: GRADE <course> <minGrade> [limit]\n";
+                return false;
+            }
+            Metrics::ScopedTimer timer(Metrics::instance().gradeQueries());
+            auto range = data.registry.gradeRange(std::string(words[1]), minGrade);
+            out += "OK ";
+            out += std::to_string(range.size());
+            size_t listed = 0;
+            for (auto it = range.begin(); it != range.end() && listed < limit; ++it, ++listed) {
+                out += ' ';
+                out += (*it)->getRollNumber();
+            }
+            out += '\n';
+        } else if (command == "ROLL" && words.size() == 2) {
+            const auto* student = data.registry.findByRollNumber(std::string(words[1]));
+            if (!student) {
+                out += "NONE\n";
+                return false;
+            }
+            out += "OK ";
+            out += student->getRollNumber();
+            out += ' ';
+            out += std::to_string(student->getStartingYear());
+            out += ' ';
+            out += student->getBranch();
+            out += ' ';
+            out += student->getName();
+            out += '\n';
+        } else if (command == "RANGE" && (words.size() == 3 || words.size() == 4)) {
+            if (words.size() == 4 && !parseLimit(words[3], limit)) {
+                out += "ERR usage: RANGE <fromRoll> <toRoll> [limit]\n";
+                return false;
+            }
+            size_t total = 0;
+            auto students = data.registry.studentsInRollRange(std::string(words[1]),
+                                                              std::string(words[2]), limit,
+                                                              &total);
+            out += "OK ";
+            out += std::to_string(total);
+            for (const auto* student : students) {
+                out += ' ';
+                out += student->getRollNumber();
+            }
+            out += '\n';
+        } else {
+            out += "ERR unknown request\n";
+        }
+        return false;
+    }
+
+    // Binds and listens on the socket path, replacing a stale socket file
+    // left by an earlier run. Returns false, after reporting on std::cerr, if
+    // the server cannot be set up.
+    bool start() {
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        if (socketPath.empty() || socketPath.size() >= sizeof(address.sun_path)) {
+            std::cerr << "Error: Invalid socket path " << socketPath << std::endl;
+            return false;
+        }
+        std::memcpy(address.sun_path, socketPath.c_str(), socketPath.size() + 1);
+
+        struct stat info;
+        if (lstat(socketPath.c_str(), &info) == 0) {
+            if (!S_ISSOCK(info.st_mode)) {
+                std::cerr << "Error: " << socketPath << " exists and is not a socket" << std::endl;
+                return false;
+            }
+            unlink(socketPath.c_str());
+        }
+
+        listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        epollFd = epoll_create1(EPOLL_CLOEXEC);
+        stopFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (listenFd < 0 || epollFd < 0 || stopFd < 0) {
+            std::cerr << "Error: Could not create server sockets: " << std::strerror(errno)
+                      << std::endl;
+            return false;
+        }
+        if (bind(listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+            listen(listenFd, SOMAXCONN) != 0) {
+            std::cerr << "Error: Could not listen on " << socketPath << ": "
+                      << std::strerror(errno) << std::endl;
+            close(listenFd);
+            listenFd = -1;
+            return false;
+        }
+        return watch(listenFd, EPOLLIN, EPOLL_CTL_ADD) && watch(stopFd, EPOLLIN, EPOLL_CTL_ADD);
+    }
+
+    // Runs the event loop until stop() is called. Call after start().
+    void run() {
+        epoll_event events[maxEvents];
+        while (true) {
+            int ready = epoll_wait(epollFd, events, maxEvents, -1);
+            if (ready < 0) {
+                if (errno == EINTR) continue;
+                std::cerr << "Error: epoll_wait failed: " << std::strerror(errno) << std::endl;
+                return;
+            }
+            for (int i = 0; i < ready; ++i) {
+                int fd = events[i].data.fd;
+                if (fd == stopFd) {
+                    return;
+                } else if (fd == listenFd) {
+                    acceptConnections();
+                } else {
+                    serviceConnection(fd, events[i].events);
+                }
+            }
+        }
+    }
+
+    // Makes run() return. Safe to call from another thread or a signal
+    // handler.
+    void stop() {
+        uint64_t one = 1;
+        ssize_t ignored = write(stopFd, &one, sizeof(one));
+        (void)ignored;
+    }
+};
+
+#endif
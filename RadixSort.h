@@ -0,0 +1,246 @@
+#ifndef RADIX_SORT_H
+#define RADIX_SORT_H
+
+#include "ThreadPool.h"
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <vector>
+
+// One element to sort: its byte key, 8 bytes of the key packed big-endian
+// starting at the depth the current pass has reached (so passes rarely touch
+// the key's memory), and its position in the input.
+struct RadixItem {
+    const unsigned char* key;
+    size_t length;
+    uint64_t prefix;
+    size_t index;
+};
+
+// MSD radix sort over byte-string keys. Each pass buckets a range on the
+// key byte at `depth` (bucket 0 holds keys that end there, so shorter keys
+// sort first) and recurses into every bucket. The resulting order is plain
+// lexicographic unsigned-byte order, the same as std::string's operator<.
+class RadixSorter {
+private:
+    static constexpr size_t bucketCount = 257;
+    static constexpr size_t smallRange = 64;
+    static constexpr size_t parallelCountRange = 1 << 16;
+    static constexpr size_t taskRange = 1 << 12;
+    
+    using Histogram = std::array<size_t, bucketCount>;
+    
+    size_t numTasks;
+    ThreadPool& pool;
+    TaskGroup& group;
+    
+public:
+    static uint64_t packKey(const unsigned char* key, size_t length, size_t depth) {
+        uint64_t prefix = 0;
+        for (size_t i = depth; i < depth + sizeof(uint64_t); ++i) {
+            prefix <<= 8;
+            if (i < length) prefix |= key[i];
+        }
+        return prefix;
+    }
+    
+private:
+    // prefixDepth is the key offset the items' packed prefixes start at; the
+    // caller keeps depth within [prefixDepth, prefixDepth + 8).
+    static size_t bucketOf(const RadixItem& item, size_t depth, size_t prefixDepth) {
+        if (depth >= item.length) return 0;
+        size_t shift = 8 * (sizeof(uint64_t) - 1 - (depth - prefixDepth));
+        return size_t((item.prefix >> shift) & 0xff) + 1;
+    }
+    
+    // Keys in a range agree before depth, so the packed prefixes decide
+    // unless they are equal.
+    static bool lessFrom(const RadixItem& a, const RadixItem& b, size_t depth,
+                         size_t prefixDepth) {
+        if (a.prefix != b.prefix) return a.prefix < b.prefix;
+        size_t from = std::max(depth, prefixDepth + sizeof(uint64_t));
+        size_t common = std::min(a.length, b.length);
+        if (from < common) {
+            int order = std::memcmp(a.key + from, b.key + from, common - from);
+            if (order != 0) return order < 0;
+        }
+        return a.length < b.length;
+    }
+    
+    template<typename Fn>
+    void forEachChunk(size_t chunks, Fn&& fn) {
+        TaskGroup chunkGroup(pool);
+        for (size_t chunk = 1; chunk < chunks; ++chunk) {
+            chunkGroup.run([&fn, chunk]() { fn(chunk); });
+        }
+        fn(0);
+        chunkGroup.wait();
+    }
+    
+    // Counts bucket sizes for data[0, n). With more than one chunk the
+    // chunks are counted in parallel and their counts kept in chunkCounts
+    // for scatter(); with one chunk chunkCounts is left empty.
+    Histogram countBuckets(const RadixItem* data, size_t n, size_t depth, size_t prefixDepth,
+                           std::vector<Histogram>& chunkCounts, size_t chunks) {
+        Histogram totals{};
+        chunkCounts.clear();
+        if (chunks == 1) {
+            for (size_t i = 0; i < n; ++i) {
+                totals[bucketOf(data[i], depth, prefixDepth)]++;
+            }
+            return totals;
+        }
+        
+        chunkCounts.assign(chunks, Histogram{});
+        forEachChunk(chunks, [&](size_t chunk) {
+            Histogram& counts = chunkCounts[chunk];
+            for (size_t i = n * chunk / chunks; i < n * (chunk + 1) / chunks; ++i) {
+                counts[bucketOf(data[i], depth, prefixDepth)]++;
+            }
+        });
+        for (const Histogram& counts : chunkCounts) {
+            for (size_t b = 0; b < bucketCount; ++b) {
+                totals[b] += counts[b];
+            }
+        }
+        return totals;
+    }
+    
+    void scatter(const RadixItem* data, RadixItem* out, size_t n, size_t depth,
+                 size_t prefixDepth, const std::vector<Histogram>& chunkCounts,
+                 const Histogram& bucketStart) {
+        if (chunkCounts.empty()) {
+            Histogram next = bucketStart;
+            for (size_t i = 0; i < n; ++i) {
+                out[next[bucketOf(data[i], depth, prefixDepth)]++] = data[i];
+            }
+            return;
+        }
+        
+        size_t chunks = chunkCounts.size();
+        std::vector<Histogram> offsets(chunks);
+        for (size_t b = 0; b < bucketCount; ++b) {
+            size_t offset = bucketStart[b];
+            for (size_t chunk = 0; chunk < chunks; ++chunk) {
+                offsets[chunk][b] = offset;
+                offset += chunkCounts[chunk][b];
+            }
+        }
+        forEachChunk(chunks, [&](size_t chunk) {
+            Histogram& next = offsets[chunk];
+            for (size_t i = n * chunk / chunks; i < n * (chunk + 1) / chunks; ++i) {
+                out[next[bucketOf(data[i], depth, prefixDepth)]++] = data[i];
+            }
+        });
+    }
+    
+public:
+    RadixSorter(size_t numTasks, ThreadPool& pool, TaskGroup& group)
+        : numTasks(std::max<size_t>(1, numTasks)), pool(pool), group(group) {}
+    
+    // Sorts data[0, n) by key bytes from `depth` on, given that all keys in
+    // the range already agree on bytes before depth. The sorted range ends up
+    // in data if dataIsOutput, otherwise in other. Large buckets are handed
+    // to the group as tasks.
+    void sort(RadixItem* data, RadixItem* other, bool dataIsOutput, size_t n, size_t depth,
+              size_t prefixDepth) {
+        std::vector<Histogram> chunkCounts;
+        Histogram counts;
+        while (true) {
+            if (depth == prefixDepth + sizeof(uint64_t)) {
+                for (size_t i = 0; i < n; ++i) {
+                    data[i].prefix = packKey(data[i].key, data[i].length, depth);
+                }
+                prefixDepth = depth;
+            }
+            if (n <= smallRange) {
+                std::sort(data, data + n, [depth, prefixDepth](const RadixItem& a,
+                                                               const RadixItem& b) {
+                    return lessFrom(a, b, depth, prefixDepth);
+                });
+                if (!dataIsOutput) std::copy(data, data + n, other);
+                return;
+            }
+            
+            size_t chunks = n >= parallelCountRange
+                ? std::min(numTasks, n / (parallelCountRange / 4)) : 1;
+            counts = countBuckets(data, n, depth, prefixDepth, chunkCounts, chunks);
+            
+            // Keys that all end here are equal and already in order, and a
+            // byte shared by the whole range needs no scatter.
+            if (counts[0] == n) {
+                if (!dataIsOutput) std::copy(data, data + n, other);
+                return;
+            }
+            if (std::find(counts.begin(), counts.end(), n) == counts.end()) break;
+            depth++;
+        }
+        
+        Histogram bucketStart{};
+        size_t offset = 0;
+        for (size_t b = 0; b < bucketCount; ++b) {
+            bucketStart[b] = offset;
+            offset += counts[b];
+        }
+        scatter(data, other, n, depth, prefixDepth, chunkCounts, bucketStart);
+        
+        // The range now lives in other. Ended keys (bucket 0) and singleton
+        // buckets are final; the rest recurse one byte deeper.
+        for (size_t b = 0; b < bucketCount; ++b) {
+            size_t start = bucketStart[b];
+            size_t size = (b + 1 < bucketCount ? bucketStart[b + 1] : n) - start;
+            if (size == 0) continue;
+            if (b == 0 || size == 1) {
+                if (dataIsOutput) std::copy(other + start, other + start + size, data + start);
+                continue;
+            }
+            RadixItem* bucketData = other + start;
+            RadixItem* bucketOther = data + start;
+            bool bucketIsOutput = !dataIsOutput;
+            size_t nextDepth = depth + 1;
+            if (size >= taskRange) {
+                group.run([this, bucketData, bucketOther, bucketIsOutput, size, nextDepth,
+                           prefixDepth]() {
+                    sort(bucketData, bucketOther, bucketIsOutput, size, nextDepth, prefixDepth);
+                });
+            } else {
+                sort(bucketData, bucketOther, bucketIsOutput, size, nextDepth, prefixDepth);
+            }
+        }
+    }
+};
+
+// Sorts data by keyOf(element), a byte string compared as unsigned bytes,
+// using a parallel MSD radix sort on pool. The keys must stay valid and
+// unchanged while data is being sorted (e.g. keys of heap objects behind
+// pointers). Elements are moved into their final position once.
+template<typename T, typename KeyFn>
+void parallelRadixSort(std::vector<T>& data, KeyFn keyOf, size_t numTasks,
+                       ThreadPool& pool = ThreadPool::instance()) {
+    if (data.size() < 2) return;
+    
+    std::vector<RadixItem> items(data.size());
+    for (size_t i = 0; i < data.size(); ++i) {
+        std::string_view key = keyOf(data[i]);
+        const unsigned char* bytes = reinterpret_cast<const unsigned char*>(key.data());
+        items[i] = {bytes, key.size(), RadixSorter::packKey(bytes, key.size(), 0), i};
+    }
+    std::vector<RadixItem> scratch(items.size());
+    {
+        TaskGroup group(pool);
+        RadixSorter sorter(numTasks, pool, group);
+        sorter.sort(items.data(), scratch.data(), true, items.size(), 0, 0);
+        group.wait();
+    }
+    
+    std::vector<T> sorted;
+    sorted.reserve(data.size());
+    for (const RadixItem& item : items) {
+        sorted.push_back(std::move(data[item.index]));
+    }
+    data.swap(sorted);
+}
+
+#endif
@@ -0,0 +1,438 @@
+#ifndef ROARING_BITMAP_H
+#define ROARING_BITMAP_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <vector>
+
+// Compressed set of 32-bit values in the style of Roaring bitmaps. Values
+// are grouped by their high 16 bits into containers; a container holds its
+// low 16 bits either as a sorted array (up to 4096 values, 2 bytes each) or,
+// when denser, as a 65536-bit bitmap (8 KB). Iteration is in ascending order.
+class RoaringBitmap {
+private:
+    static constexpr size_t arrayLimit = 4096;
+    static constexpr size_t bitmapWords = 65536 / 64;
+
+    struct Container {
+        uint16_t key = 0;
+        uint32_t cardinality = 0;
+        std::vector<uint16_t> values;
+        std::vector<uint64_t> bits;
+
+        bool isBitmap() const { return !bits.empty(); }
+
+        bool contains(uint16_t low) const {
+            if (isBitmap()) return (bits[low / 64] >> (low % 64)) & 1;
+            return std::binary_search(values.begin(), values.end(), low);
+        }
+
+        bool add(uint16_t low) {
+            if (isBitmap()) {
+                uint64_t mask = uint64_t(1) << (low % 64);
+                if (bits[low / 64] & mask) return false;
+                bits[low / 64] |= mask;
+                cardinality++;
+                return true;
+            }
+            auto it = values.end();
+            if (!values.empty() && values.back() >= low) {
+                it = std::lower_bound(values.begin(), values.end(), low);
+                if (it != values.end() && *it == low) return false;
+            }
+            values.insert(it, low);
+            cardinality++;
+            if (cardinality > arrayLimit) toBitmap();
+            return true;
+        }
+
+        bool remove(uint16_t low) {
+            if (isBitmap()) {
+                uint64_t mask = uint64_t(1) << (low % 64);
+                if (!(bits[low / 64] & mask)) return false;
+                bits[low / 64] &= ~mask;
+                cardinality--;
+                // Shrink back well below the limit so alternating adds and
+                // removes at the boundary do not keep converting.
+                if (cardinality <= arrayLimit / 2) compact();
+                return true;
+            }
+            auto it = std::lower_bound(values.begin(), values.end(), low);
+            if (it == values.end() || *it != low) return false;
+            values.erase(it);
+            cardinality--;
+            return true;
+        }
+
+        void toBitmap() {
+            bits.assign(bitmapWords, 0);
+            for (uint16_t low : values) {
+                bits[low / 64] |= uint64_t(1) << (low % 64);
+            }
+            values.clear();
+            values.shrink_to_fit();
+        }
+
+        void recount() {
+            cardinality = 0;
+            for (uint64_t word : bits) {
+                cardinality += static_cast<uint32_t>(__builtin_popcountll(word));
+            }
+        }
+
+        // Bitmaps that became sparse (e.g. after an intersection) go back to
+        // the array form.
+        void compact() {
+            if (!isBitmap() || cardinality > arrayLimit) return;
+            values.clear();
+            values.reserve(cardinality);
+            for (size_t w = 0; w < bitmapWords; ++w) {
+                for (uint64_t word = bits[w]; word != 0; word &= word - 1) {
+                    values.push_back(static_cast<uint16_t>(w * 64 + __builtin_ctzll(word)));
+                }
+            }
+            bits.clear();
+            bits.shrink_to_fit();
+        }
+    };
+
+    std::vector<Container> containers;
+    size_t total = 0;
+
+    static void unite(Container& into, const Container& other) {
+        if (!into.isBitmap() && !other.isBitmap()) {
+            std::vector<uint16_t> merged;
+            merged.reserve(into.values.size() + other.values.size());
+            std::set_union(into.values.begin(), into.values.end(), other.values.begin(),
+                           other.values.end(), std::back_inserter(merged));
+            into.values = std::move(merged);
+            into.cardinality = static_cast<uint32_t>(into.values.size());
+            if (into.cardinality > arrayLimit) into.toBitmap();
+            return;
+        }
+        if (!into.isBitmap()) into.toBitmap();
+        if (other.isBitmap()) {
+            for (size_t w = 0; w < bitmapWords; ++w) {
+                into.bits[w] |= other.bits[w];
+            }
+        } else {
+            for (uint16_t low : other.values) {
+                into.bits[low / 64] |= uint64_t(1) << (low % 64);
+            }
+        }
+        into.recount();
+    }
+
+    static void intersect(Container& into, const Container& other) {
+        if (!into.isBitmap() && !other.isBitmap()) {
+            auto end = std::set_intersection(into.values.begin(), into.values.end(),
+                                             other.values.begin(), other.values.end(),
+                                             into.values.begin());
+            into.values.erase(end, into.values.end());
+            into.cardinality = static_cast<uint32_t>(into.values.size());
+            return;
+        }
+        if (!into.isBitmap()) {
+            auto end = std::remove_if(into.values.begin(), into.values.end(),
+                                      [&other](uint16_t low) { return !other.contains(low); });
+            into.values.erase(end, into.values.end());
+            into.cardinality = static_cast<uint32_t>(into.values.size());
+            return;
+        }
+        if (!other.isBitmap()) {
+            std::vector<uint16_t> kept;
+            for (uint16_t low : other.values) {
+                if (into.contains(low)) kept.push_back(low);
+            }
+            into.bits.clear();
+            into.bits.shrink_to_fit();
+            into.values = std::move(kept);
+            into.cardinality = static_cast<uint32_t>(into.values.size());
+            return;
+        }
+        for (size_t w = 0; w < bitmapWords; ++w) {
+            into.bits[w] &= other.bits[w];
+        }
+        into.recount();
+        into.compact();
+    }
+
+public:
+    class const_iterator {
+    private:
+        const std::vector<Container>* containers = nullptr;
+        size_t index = 0;
+        // Index into an array container, or the bit number in a bitmap one.
+        uint32_t position = 0;
+        uint32_t high = 0;
+        // The current array container's values; null for bitmap containers.
+        const uint16_t* values = nullptr;
+        uint32_t count = 0;
+        // Bits of the current bitmap word from position on.
+        uint64_t word = 0;
+
+        // Moves to the first value of the first non-empty container from index.
+        void enter() {
+            for (; index < containers->size(); ++index) {
+                const Container& container = (*containers)[index];
+                high = uint32_t(container.key) << 16;
+                position = 0;
+                if (!container.isBitmap()) {
+                    values = container.values.data();
+                    count = static_cast<uint32_t>(container.values.size());
+                    if (count > 0) return;
+                    continue;
+                }
+                values = nullptr;
+                if (nextWord(container, 0)) return;
+            }
+            position = 0;
+            values = nullptr;
+        }
+
+        bool nextWord(const Container& container, size_t from) {
+            for (size_t w = from; w < bitmapWords; ++w) {
+                if (container.bits[w] != 0) {
+                    word = container.bits[w];
+                    position = static_cast<uint32_t>(w * 64 + __builtin_ctzll(word));
+                    return true;
+                }
+            }
+            return false;
+        }
+
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = uint32_t;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const uint32_t*;
+        using reference = uint32_t;
+
+        const_iterator() = default;
+
+        const_iterator(const std::vector<Container>* containers, size_t index)
+            : containers(containers), index(index) {
+            enter();
+        }
+
+        uint32_t operator*() const {
+            return high | (values ? values[position] : position);
+        }
+
+        const_iterator& operator++() {
+            if (values) {
+                if (++position < count) return *this;
+            } else {
+                word &= word - 1;
+                if (word != 0) {
+                    position = (position & ~uint32_t(63)) | __builtin_ctzll(word);
+                    return *this;
+                }
+                if (nextWord((*containers)[index], position / 64 + 1)) return *this;
+            }
+            ++index;
+            enter();
+            return *this;
+        }
+
+        const_iterator operator++(int) {
+            const_iterator tmp = *this;
+            ++*this;
+            return tmp;
+        }
+
+        bool operator==(const const_iterator& other) const {
+            return index == other.index && position == other.position;
+        }
+
+        bool operator!=(const const_iterator& other) const {
+            return !(*this == other);
+        }
+    };
+
+    const_iterator begin() const { return const_iterator(&containers, 0); }
+    const_iterator end() const { return const_iterator(&containers, containers.size()); }
+
+    size_t cardinality() const { return total; }
+    bool empty() const { return total == 0; }
+
+    // Adding values in ascending order only ever touches the last container.
+    bool add(uint32_t value) {
+        uint16_t key = static_cast<uint16_t>(value >> 16);
+        auto it = containers.end();
+        if (containers.empty() || containers.back().key < key) {
+            containers.emplace_back();
+            containers.back().key = key;
+            it = containers.end() - 1;
+        } else if (containers.back().key == key) {
+            it = containers.end() - 1;
+        } else {
+            it = std::lower_bound(containers.begin(), containers.end(), key,
+                                  [](const Container& c, uint16_t k) { return c.key < k; });
+            if (it == containers.end() || it->key != key) {
+                it = containers.emplace(it);
+                it->key = key;
+            }
+        }
+        bool added = it->add(static_cast<uint16_t>(value & 0xffff));
+        total += added;
+        return added;
+    }
+
+    bool remove(uint32_t value) {
+        uint16_t key = static_cast<uint16_t>(value >> 16);
+        auto it = std::lower_bound(containers.begin(), containers.end(), key,
+                                   [](const Container& c, uint16_t k) { return c.key < k; });
+        if (it == containers.end() || it->key != key ||
+            !it->remove(static_cast<uint16_t>(value & 0xffff))) {
+            return false;
+        }
+        if (it->cardinality == 0) containers.erase(it);
+        total--;
+        return true;
+    }
+
+    bool contains(uint32_t value) const {
+        uint16_t key = static_cast<uint16_t>(value >> 16);
+        auto it = std::lower_bound(containers.begin(), containers.end(), key,
+                                   [](const Container& c, uint16_t k) { return c.key < k; });
+        return it != containers.end() && it->key == key &&
+               it->contains(static_cast<uint16_t>(value & 0xffff));
+    }
+
+    RoaringBitmap& operator|=(const RoaringBitmap& other) {
+        std::vector<Container> merged;
+        merged.reserve(containers.size() + other.containers.size());
+        size_t i = 0;
+        size_t j = 0;
+        while (i < containers.size() || j < other.containers.size()) {
+            if (j == other.containers.size() ||
+                (i < containers.size() && containers[i].key < other.containers[j].key)) {
+                merged.push_back(std::move(containers[i++]));
+            } else if (i == containers.size() || other.containers[j].key < containers[i].key) {
+                merged.push_back(other.containers[j++]);
+            } else {
+                merged.push_back(std::move(containers[i++]));
+                unite(merged.back(), other.containers[j++]);
+            }
+        }
+        containers = std::move(merged);
+        total = 0;
+        for (const Container& container : containers) {
+            total += container.cardinality;
+        }
+        return *this;
+    }
+
+    RoaringBitmap& operator&=(const RoaringBitmap& other) {
+        std::vector<Container> kept;
+        size_t j = 0;
+        for (Container& container : containers) {
+            while (j < other.containers.size() && other.containers[j].key < container.key) j++;
+            if (j == other.containers.size()) break;
+            if (other.containers[j].key != container.key) continue;
+            intersect(container, other.containers[j]);
+            if (container.cardinality > 0) kept.push_back(std::move(container));
+        }
+        containers = std::move(kept);
+        total = 0;
+        for (const Container& container : containers) {
+            total += container.cardinality;
+        }
+        return *this;
+    }
+
+    // Union of several bitmaps, built one container key at a time: keys
+    // present in a single input are copied, the rest are OR-ed into a dense
+    // container and compacted.
+    static RoaringBitmap unionOf(const std::vector<const RoaringBitmap*>& inputs) {
+        RoaringBitmap result;
+        std::vector<size_t> cursors(inputs.size(), 0);
+        std::vector<const Container*> matching;
+        while (true) {
+            bool found = false;
+            uint16_t key = 0;
+            for (size_t i = 0; i < inputs.size(); ++i) {
+                if (cursors[i] < inputs[i]->containers.size()) {
+                    uint16_t candidate = inputs[i]->containers[cursors[i]].key;
+                    if (!found || candidate < key) key = candidate;
+                    found = true;
+                }
+            }
+            if (!found) break;
+            
+            matching.clear();
+            for (size_t i = 0; i < inputs.size(); ++i) {
+                if (cursors[i] < inputs[i]->containers.size() &&
+                    inputs[i]->containers[cursors[i]].key == key) {
+                    matching.push_back(&inputs[i]->containers[cursors[i]++]);
+                }
+            }
+            if (matching.size() == 1) {
+                result.containers.push_back(*matching[0]);
+            } else {
+                Container merged;
+                merged.key = key;
+                merged.bits.assign(bitmapWords, 0);
+                for (const Container* container : matching) {
+                    if (container->isBitmap()) {
+                        for (size_t w = 0; w < bitmapWords; ++w) {
+                            merged.bits[w] |= container->bits[w];
+                        }
+                    } else {
+                        for (uint16_t low : container->values) {
+                            merged.bits[low / 64] |= uint64_t(1) << (low % 64);
+                        }
+                    }
+                }
+                merged.recount();
+                merged.compact();
+                result.containers.push_back(std::move(merged));
+            }
+            result.total += result.containers.back().cardinality;
+        }
+        return result;
+    }
+
+    std::vector<uint32_t> toVector() const {
+        std::vector<uint32_t> result;
+        result.reserve(total);
+        for (const Container& container : containers) {
+            uint32_t high = uint32_t(container.key) << 16;
+            if (container.isBitmap()) {
+                for (size_t w = 0; w < bitmapWords; ++w) {
+                    for (uint64_t word = container.bits[w]; word != 0; word &= word - 1) {
+                        result.push_back(high | static_cast<uint32_t>(w * 64 +
+                                                                      __builtin_ctzll(word)));
+                    }
+                }
+            } else {
+                for (uint16_t low : container.values) {
+                    result.push_back(high | low);
+                }
+            }
+        }
+        return result;
+    }
+
+    void shrinkToFit() {
+        containers.shrink_to_fit();
+        for (Container& container : containers) {
+            container.values.shrink_to_fit();
+        }
+    }
+
+    // Heap bytes owned by the bitmap, not counting sizeof(RoaringBitmap).
+    size_t memoryUsage() const {
+        size_t bytes = containers.capacity() * sizeof(Container);
+        for (const Container& container : containers) {
+            bytes += container.values.capacity() * sizeof(uint16_t) +
+                     container.bits.capacity() * sizeof(uint64_t);
+        }
+        return bytes;
+    }
+};
+
+#endif
@@ -0,0 +1,176 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+// Layout of the file written by StudentRegistry::saveSnapshot. Values are in
+// host byte order; sections start on 8-byte boundaries so fixed-size arrays
+// can be used straight from a mapping of the file.
+//
+//   header
+//   courses         courseCount codes, indexed by the saved CourseId
+//   record offsets  studentCount uint64 file offsets of the student records
+//   records         name, roll number, branch, startingYear, course counts,
+//                   then (CourseId, grade) pairs, current courses first
+//   original order  studentCount uint32 handles
+//   sorted order    studentCount uint32 handles
+//   grade index     per course: uint64 count, then count GradeEntry
+struct SnapshotHeader {
+    static constexpr char expectedMagic[8] = {'E', 'R', 'P', 'S', 'N', 'A', 'P', '\0'};
+    static constexpr uint32_t currentVersion = 1;
+    
+    char magic[8];
+    uint32_t version;
+    uint32_t keyTypes;
+    uint64_t studentCount;
+    uint64_t courseCount;
+    uint64_t coursesOffset;
+    uint64_t recordOffsetsOffset;
+    uint64_t originalOrderOffset;
+    uint64_t sortedOrderOffset;
+    uint64_t gradeIndexOffset;
+    uint64_t fileSize;
+};
+
+// Identifies how a roll number or course code type is encoded, so a
+// snapshot is only loaded into a registry with the same R and C.
+template<typename T>
+constexpr uint32_t snapshotTypeTag() {
+    if constexpr (std::is_same_v<T, std::string>) {
+        return 0x100;
+    } else {
+        static_assert(std::is_arithmetic_v<T>, "snapshot keys must be strings or arithmetic");
+        return 0x200 | (std::is_floating_point_v<T> ? 0x80 : 0) |
+               (std::is_signed_v<T> ? 0x40 : 0) | static_cast<uint32_t>(sizeof(T));
+    }
+}
+
+class SnapshotWriter {
+private:
+    std::string buffer;
+
+public:
+    size_t position() const { return buffer.size(); }
+
+    void align() {
+        buffer.resize((buffer.size() + 7) & ~size_t(7), '\0');
+    }
+
+    template<typename T>
+    void put(const T& value) {
+        static_assert(std::is_trivially_copyable_v<T>, "put() needs a trivially copyable type");
+        buffer.append(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    template<typename T>
+    void putArray(const T* values, size_t count) {
+        static_assert(std::is_trivially_copyable_v<T>, "putArray() needs a trivially copyable type");
+        buffer.append(reinterpret_cast<const char*>(values), sizeof(T) * count);
+    }
+
+    void putString(std::string_view str) {
+        put(static_cast<uint32_t>(str.size()));
+        buffer.append(str.data(), str.size());
+    }
+
+    // Strings and arithmetic values, matching snapshotTypeTag.
+    template<typename T>
+    void putValue(const T& value) {
+        if constexpr (std::is_same_v<T, std::string>) {
+            putString(value);
+        } else {
+            put(value);
+        }
+    }
+
+    template<typename T>
+    void patch(size_t offset, const T& value) {
+        std::memcpy(&buffer[offset], &value, sizeof(T));
+    }
+
+    bool writeTo(const std::string& filename) const {
+        std::ofstream out(filename, std::ios::binary | std::ios::trunc);
+        out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        return static_cast<bool>(out);
+    }
+};
+
+// Bounds-checked cursor over a mapped snapshot. Every read fails instead of
+// running past the end, and a failed read leaves the reader failed.
+class SnapshotReader {
+private:
+    std::string_view data;
+    size_t pos = 0;
+    bool ok = true;
+
+    bool take(size_t size) {
+        if (!ok || size > data.size() - pos) {
+            ok = false;
+            return false;
+        }
+        return true;
+    }
+
+public:
+    explicit SnapshotReader(std::string_view data) : data(data) {}
+
+    bool good() const { return ok; }
+
+    bool seek(uint64_t offset) {
+        if (!ok || offset > data.size()) {
+            ok = false;
+            return false;
+        }
+        pos = static_cast<size_t>(offset);
+        return true;
+    }
+
+    template<typename T>
+    bool get(T& value) {
+        static_assert(std::is_trivially_copyable_v<T>, "get() needs a trivially copyable type");
+        if (!take(sizeof(T))) return false;
+        std::memcpy(&value, data.data() + pos, sizeof(T));
+        pos += sizeof(T);
+        return true;
+    }
+
+    template<typename T>
+    bool getArray(T* values, size_t count) {
+        static_assert(std::is_trivially_copyable_v<T>, "getArray() needs a trivially copyable type");
+        if (count == 0) return ok;
+        if (count > data.size() / sizeof(T) || !take(sizeof(T) * count)) {
+            ok = false;
+            return false;
+        }
+        std::memcpy(values, data.data() + pos, sizeof(T) * count);
+        pos += sizeof(T) * count;
+        return true;
+    }
+
+    bool getString(std::string_view& str) {
+        uint32_t size = 0;
+        if (!get(size) || !take(size)) return false;
+        str = data.substr(pos, size);
+        pos += size;
+        return true;
+    }
+
+    template<typename T>
+    bool getValue(T& value) {
+        if constexpr (std::is_same_v<T, std::string>) {
+            std::string_view str;
+            if (!getString(str)) return false;
+            value.assign(str.data(), str.size());
+            return true;
+        } else {
+            return get(value);
+        }
+    }
+};
+
+#endif
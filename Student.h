@@ -1,125 +1,175 @@
 #ifndef STUDENT_H
 #define STUDENT_H
 
+#include "FlatMap.h"
+#include "CourseTable.h"
 #include <string>
-#include <map>
 #include <iostream>
 #include <sstream>
 #include <algorithm>
 #include <cctype>
+#include <cstdint>
+#include <optional>
+#include <type_traits>
 
 template<typename R, typename C>
 class Student {
+public:
+    using CourseMap = FlatMap<CourseKey<C>, double, 4>;
+
 private:
     static bool isNumericString(const std::string& str) {
         return !str.empty() && std::all_of(str.begin(), str.end(), ::isdigit);
     }
     
-    static bool compareRollNumbers(const std::string& a, const std::string& b) {
-        bool aIsNumeric = isNumericString(a);
-        bool bIsNumeric = isNumericString(b);
-        
-        if (aIsNumeric && bIsNumeric) {
-            try {
-                long long aNum = std::stoll(a);
-                long long bNum = std::stoll(b);
-                return aNum < bNum;
-            } catch (...) {
-                if (a.length() < b.length()) return true;
-                if (a.length() > b.length()) return false;
-                return a < b;
-            }
+    static unsigned char keyByte(char c) {
+        return static_cast<unsigned char>(c) ^ (std::is_signed<char>::value ? 0x80 : 0x00);
+    }
+    
+    static void appendRunLength(std::string& key, size_t length) {
+        unsigned char bytes[sizeof(size_t)];
+        int count = 0;
+        while (length > 0) {
+            bytes[count++] = static_cast<unsigned char>(length & 0xff);
+            length >>= 8;
         }
-        
-        if (aIsNumeric && !bIsNumeric) {
-            return true;
+        key.push_back(static_cast<char>(count));
+        while (count > 0) {
+            key.push_back(static_cast<char>(bytes[--count]));
         }
+    }
+    
+    // Encodes a roll number so that plain byte-wise comparison of two keys
+    // gives the natural order: numeric roll numbers first, ordered by value,
+    // then alphanumeric ones with each digit run ordered by length and digits.
+    static std::string makeSortKey(const std::string& roll) {
+        std::string key;
+        key.reserve(roll.size() + 4);
         
-        if (!aIsNumeric && bIsNumeric) {
-            return false;
+        if (isNumericString(roll)) {
+            size_t first = roll.find_first_not_of('0');
+            if (first == std::string::npos) first = roll.size();
+            key.push_back('\0');
+            appendRunLength(key, roll.size() - first);
+            key.append(roll, first, std::string::npos);
+            return key;
         }
         
-        size_t aPos = 0, bPos = 0;
-        while (aPos < a.length() && bPos < b.length()) {
-            bool aIsDigit = std::isdigit(static_cast<unsigned char>(a[aPos]));
-            bool bIsDigit = std::isdigit(static_cast<unsigned char>(b[bPos]));
-            
-            if (aIsDigit && bIsDigit) {
-                size_t aNumStart = aPos;
-                size_t bNumStart = bPos;
-                while (aPos < a.length() && std::isdigit(static_cast<unsigned char>(a[aPos]))) aPos++;
-                while (bPos < b.length() && std::isdigit(static_cast<unsigned char>(b[bPos]))) bPos++;
-                
-                std::string aNum = a.substr(aNumStart, aPos - aNumStart);
-                std::string bNum = b.substr(bNumStart, bPos - bNumStart);
-                
-                if (aNum.length() < bNum.length()) return true;
-                if (aNum.length() > bNum.length()) return false;
-                if (aNum != bNum) return aNum < bNum;
+        key.push_back('\1');
+        size_t pos = 0;
+        while (pos < roll.length()) {
+            if (std::isdigit(static_cast<unsigned char>(roll[pos]))) {
+                size_t start = pos;
+                while (pos < roll.length() && std::isdigit(static_cast<unsigned char>(roll[pos]))) pos++;
+                key.push_back(static_cast<char>(keyByte('0')));
+                appendRunLength(key, pos - start);
+                key.append(roll, start, pos - start);
             } else {
-                if (a[aPos] != b[bPos]) {
-                    return a[aPos] < b[bPos];
-                }
-                aPos++;
-                bPos++;
+                key.push_back(static_cast<char>(keyByte(roll[pos])));
+                pos++;
             }
         }
-        
-        return a.length() < b.length();
+        return key;
+    }
+    
+    static uint64_t keyPrefix(const std::string& key) {
+        uint64_t prefix = 0;
+        for (size_t i = 0; i < sizeof(uint64_t); ++i) {
+            prefix <<= 8;
+            if (i < key.size()) prefix |= static_cast<unsigned char>(key[i]);
+        }
+        return prefix;
+    }
+    
+    static std::optional<CourseKey<C>> findCourseKey(const C& courseCode) {
+        if constexpr (std::is_same_v<CourseKey<C>, InternedCourse>) {
+            return InternedCourse::find(courseCode);
+        } else {
+            return courseCode;
+        }
+    }
+    
+    double gradeOf(const CourseKey<C>& courseKey) const {
+        auto it = previousCourses.find(courseKey);
+        if (it != previousCourses.end()) {
+            return it->second;
+        }
+        it = currentCourses.find(courseKey);
+        if (it != currentCourses.end()) {
+            return it->second;
+        }
+        return -1.0;
+    }
+    
+    void updateSortKey() {
+        if constexpr (std::is_same_v<R, std::string>) {
+            sortKey = makeSortKey(rollNumber);
+            sortPrefix = keyPrefix(sortKey);
+        }
     }
 private:
     std::string name;
     R rollNumber;
     std::string branch;
     int startingYear;
-    std::map<C, double> currentCourses;
-    std::map<C, double> previousCourses;
+    CourseMap currentCourses;
+    CourseMap previousCourses;
+    std::string sortKey;
+    uint64_t sortPrefix = 0;
 
 public:
     Student(const std::string& name, const R& rollNumber, 
             const std::string& branch, int startingYear)
         : name(name), rollNumber(rollNumber), branch(branch), 
-          startingYear(startingYear) {}
+          startingYear(startingYear) {
+        updateSortKey();
+    }
 
     std::string getName() const { return name; }
     R getRollNumber() const { return rollNumber; }
     std::string getBranch() const { return branch; }
     int getStartingYear() const { return startingYear; }
-    const std::map<C, double>& getCurrentCourses() const { return currentCourses; }
-    const std::map<C, double>& getPreviousCourses() const { return previousCourses; }
+    const CourseMap& getCurrentCourses() const { return currentCourses; }
+    const CourseMap& getPreviousCourses() const { return previousCourses; }
+    const std::string& getSortKey() const { return sortKey; }
 
     void setName(const std::string& name) { this->name = name; }
-    void setRollNumber(const R& rollNumber) { this->rollNumber = rollNumber; }
+    void setRollNumber(const R& rollNumber) {
+        this->rollNumber = rollNumber;
+        updateSortKey();
+    }
     void setBranch(const std::string& branch) { this->branch = branch; }
     void setStartingYear(int year) { startingYear = year; }
 
-    void addCurrentCourse(const C& courseCode, double grade) {
+    void addCurrentCourse(const CourseKey<C>& courseCode, double grade) {
         currentCourses[courseCode] = grade;
     }
 
-    void addPreviousCourse(const C& courseCode, double grade) {
+    void addPreviousCourse(const CourseKey<C>& courseCode, double grade) {
         previousCourses[courseCode] = grade;
     }
 
     void completeCourse(const C& courseCode) {
-        auto it = currentCourses.find(courseCode);
+        auto key = findCourseKey(courseCode);
+        if (!key) return;
+        auto it = currentCourses.find(*key);
         if (it != currentCourses.end()) {
             double grade = it->second;
             currentCourses.erase(it);
-            previousCourses[courseCode] = grade;
+            previousCourses[*key] = grade;
         }
     }
 
     double getGrade(const C& courseCode) const {
-        auto it = previousCourses.find(courseCode);
-        if (it != previousCourses.end()) {
-            return it->second;
-        }
-        it = currentCourses.find(courseCode);
-        if (it != currentCourses.end()) {
-            return it->second;
-        }
-        return -1.0;
+        auto key = findCourseKey(courseCode);
+        return key ? gradeOf(*key) : -1.0;
+    }
+
+    // Lookup by an already interned key, skipping the course table.
+    template<typename K, typename = std::enable_if_t<std::is_same_v<K, CourseKey<C>> &&
+                                                     !std::is_same_v<K, C>>>
+    double getGrade(const K& courseKey) const {
+        return gradeOf(courseKey);
     }
 
     bool operator==(const Student& other) const {
@@ -128,7 +178,8 @@ public:
 
     bool operator<(const Student& other) const {
         if constexpr (std::is_same_v<R, std::string>) {
-            return compareRollNumbers(rollNumber, other.rollNumber);
+            if (sortPrefix != other.sortPrefix) return sortPrefix < other.sortPrefix;
+            return sortKey < other.sortKey;
         } else {
             return rollNumber < other.rollNumber;
         }
@@ -0,0 +1,157 @@
+#ifndef STUDENT_ARENA_H
+#define STUDENT_ARENA_H
+
+#include "Student.h"
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+using StudentHandle = std::uint32_t;
+
+// Owns students in a small number of contiguous blocks whose sizes double
+// (1024, 2048, 4096, ...). Blocks are never moved or reallocated, so a handle
+// stays valid for the arena's lifetime. A student's record can be replaced
+// by an edited copy under the same handle: replace() publishes the copy
+// through the slot's current pointer, which readers load without a lock, and
+// keeps the superseded version readable until compact().
+template<typename R, typename C>
+class StudentArena {
+private:
+    static constexpr unsigned firstBlockBits = 10;
+    static constexpr size_t maxBlocks = 32 - firstBlockBits;
+
+    struct Slot {
+        Student<R, C> record;
+        // &record, or a heap copy installed by replace().
+        std::atomic<Student<R, C>*> current;
+
+        template<typename... Args>
+        explicit Slot(Args&&... args) : record(std::forward<Args>(args)...), current(&record) {}
+    };
+
+    std::array<Slot*, maxBlocks> blocks{};
+    size_t count = 0;
+    std::allocator<Slot> allocator;
+    // Handles whose slot record has been superseded by a heap copy, and the
+    // heap copies superseded in turn, both waiting for compact().
+    std::vector<StudentHandle> replaced;
+    std::vector<std::unique_ptr<Student<R, C>>> superseded;
+
+    static size_t blockSize(size_t block) {
+        return size_t(1) << (block + firstBlockBits);
+    }
+
+    static std::pair<size_t, size_t> locate(StudentHandle handle) {
+        uint64_t biased = static_cast<uint64_t>(handle) + (uint64_t(1) << firstBlockBits);
+        size_t bit = 63 - static_cast<size_t>(__builtin_clzll(biased));
+        size_t block = bit - firstBlockBits;
+        return {block, static_cast<size_t>(biased - (uint64_t(1) << bit))};
+    }
+
+    Slot& slot(StudentHandle handle) const {
+        auto [block, offset] = locate(handle);
+        return blocks[block][offset];
+    }
+
+    // Moves a heap current version back into the slot's own record.
+    static void settle(Slot& entry) {
+        Student<R, C>* current = entry.current.load(std::memory_order_relaxed);
+        if (current == &entry.record) return;
+        entry.record = std::move(*current);
+        entry.current.store(&entry.record, std::memory_order_release);
+        delete current;
+    }
+
+public:
+    StudentArena() = default;
+    StudentArena(const StudentArena&) = delete;
+    StudentArena& operator=(const StudentArena&) = delete;
+
+    ~StudentArena() {
+        for (size_t i = 0; i < count; ++i) {
+            Slot& entry = slot(static_cast<StudentHandle>(i));
+            Student<R, C>* current = entry.current.load(std::memory_order_relaxed);
+            if (current != &entry.record) delete current;
+            std::allocator_traits<std::allocator<Slot>>::destroy(allocator, &entry);
+        }
+        for (size_t block = 0; block < maxBlocks; ++block) {
+            if (blocks[block]) {
+                allocator.deallocate(blocks[block], blockSize(block));
+            }
+        }
+    }
+
+    template<typename... Args>
+    StudentHandle emplace(Args&&... args) {
+        StudentHandle handle = static_cast<StudentHandle>(count);
+        auto [block, offset] = locate(handle);
+        if (!blocks[block]) {
+            blocks[block] = allocator.allocate(blockSize(block));
+        }
+        std::allocator_traits<std::allocator<Slot>>::construct(
+            allocator, blocks[block] + offset, std::forward<Args>(args)...);
+        count++;
+        return handle;
+    }
+
+    // The current version of the student at handle.
+    const Student<R, C>& operator[](StudentHandle handle) const {
+        return *slot(handle).current.load(std::memory_order_acquire);
+    }
+
+    // Makes student the current version at handle. The version it replaces
+    // stays valid until compact(). Writers (replace, clear, compact) must
+    // not run concurrently with each other.
+    void replace(StudentHandle handle, Student<R, C>&& student) {
+        Slot& entry = slot(handle);
+        auto fresh = std::make_unique<Student<R, C>>(std::move(student));
+        Student<R, C>* previous = entry.current.exchange(fresh.release(),
+                                                         std::memory_order_acq_rel);
+        if (previous == &entry.record) {
+            replaced.push_back(handle);
+        } else {
+            superseded.emplace_back(previous);
+        }
+    }
+
+    // Drops the contents of a record nobody will read again (e.g. a removed
+    // student's), keeping its handle allocated. Same rules as compact().
+    void clear(StudentHandle handle) {
+        Slot& entry = slot(handle);
+        settle(entry);
+        entry.record = Student<R, C>(std::string(), R{}, std::string(), 0);
+    }
+
+    // Frees every superseded version and moves each current version back
+    // into its slot. References to students obtained before the call are
+    // invalidated, so no other thread may be reading the arena.
+    void compact() {
+        for (StudentHandle handle : replaced) {
+            settle(slot(handle));
+        }
+        replaced.clear();
+        replaced.shrink_to_fit();
+        superseded.clear();
+        superseded.shrink_to_fit();
+    }
+
+    // Number of superseded versions compact() would reclaim.
+    size_t supersededCount() const {
+        return replaced.size() + superseded.size();
+    }
+
+    size_t size() const { return count; }
+
+    size_t capacity() const {
+        size_t total = 0;
+        for (size_t block = 0; block < maxBlocks && blocks[block]; ++block) {
+            total += blockSize(block);
+        }
+        return total;
+    }
+};
+
+#endif
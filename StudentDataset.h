@@ -0,0 +1,148 @@
+#ifndef STUDENT_DATASET_H
+#define STUDENT_DATASET_H
+
+#include "StudentRegistry.h"
+#include "CSVReader.h"
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/stat.h>
+
+// A registry of the students in one CSV file, loaded on first use and shared
+// by every later caller. Each get() or current() checks
+// the file's modification time and size and reloads only when one of them
+// changed, so repeated operations on an unchanged file cost only a stat().
+// get() reloads before returning; current() reloads on a background thread
+// and keeps returning the old data until the new data is ready.
+template<typename R, typename C>
+class StudentDataset {
+public:
+    // The registry holds the only copy of the students; the vector the CSV
+    // reader returns is dropped once they are added.
+    struct Data {
+        StudentRegistry<R, C> registry;
+    };
+
+private:
+    struct FileVersion {
+        long long seconds = -1;
+        long long nanoseconds = 0;
+        long long size = -1;
+
+        bool operator==(const FileVersion& other) const {
+            return seconds == other.seconds && nanoseconds == other.nanoseconds &&
+                   size == other.size;
+        }
+    };
+
+    std::string filename;
+    int numThreads;
+    mutable std::mutex loadMutex;
+    std::shared_ptr<const Data> data;
+    FileVersion loadedVersion;
+    size_t loads = 0;
+    bool reloading = false;
+    std::thread reloader;
+
+    bool currentVersion(FileVersion& version) const {
+        struct stat info;
+        if (stat(filename.c_str(), &info) != 0) return false;
+        version.seconds = static_cast<long long>(info.st_mtim.tv_sec);
+        version.nanoseconds = static_cast<long long>(info.st_mtim.tv_nsec);
+        version.size = static_cast<long long>(info.st_size);
+        return true;
+    }
+
+    // Null if the file could not be read or held no students (e.g. it was
+    // caught half-written), so a failed reload never replaces good data.
+    std::shared_ptr<const Data> read() const {
+        auto fresh = std::make_shared<Data>();
+        fresh->registry.addStudents(CSVReader::read<R, C>(filename, numThreads));
+        if (fresh->registry.size() == 0) return nullptr;
+        return fresh;
+    }
+
+    // Caller holds loadMutex.
+    void install(std::shared_ptr<const Data> fresh, const FileVersion& version) {
+        data = std::move(fresh);
+        loadedVersion = version;
+        loads++;
+    }
+
+public:
+    explicit StudentDataset(std::string filename,
+                            int numThreads = static_cast<int>(
+                                std::max(1u, std::thread::hardware_concurrency())))
+        : filename(std::move(filename)), numThreads(numThreads) {}
+
+    StudentDataset(const StudentDataset&) = delete;
+    StudentDataset& operator=(const StudentDataset&) = delete;
+
+    ~StudentDataset() {
+        if (reloader.joinable()) reloader.join();
+    }
+
+    // Returns the loaded data, reading the file first if this is the first
+    // call or the file changed since the last read; reloaded (if given) says
+    // which. If the file is missing, unreadable or holds no students the
+    // previous data is kept and the next call tries again, so this returns
+    // null only when the file has never been read successfully. The version
+    // is taken before reading, so a write racing the read triggers another
+    // reload on the next call. Holders of an older Data keep it alive.
+    std::shared_ptr<const Data> get(bool* reloaded = nullptr) {
+        std::lock_guard<std::mutex> lock(loadMutex);
+        if (reloaded) *reloaded = false;
+        FileVersion version;
+        if (!currentVersion(version)) {
+            if (!data) {
+                std::cerr << "Error: Could not open file " << filename << std::endl;
+            }
+            return data;
+        }
+        if (data && version == loadedVersion) return data;
+
+        auto fresh = read();
+        if (!fresh) return data;
+        install(std::move(fresh), version);
+        if (reloaded) *reloaded = true;
+        return data;
+    }
+
+    // Returns the loaded data without waiting for a read: if the file has
+    // changed (or was never loaded) this starts reading it on a background
+    // thread and returns what is loaded now, which is null until the first
+    // read completes. The new data replaces the old once it is built, unless
+    // a get() loaded the file in the meantime or the read failed (see get()),
+    // in which case the old data stays and a later call reads again.
+    std::shared_ptr<const Data> current() {
+        std::lock_guard<std::mutex> lock(loadMutex);
+        FileVersion version;
+        if (reloading || !currentVersion(version) || (data && version == loadedVersion)) {
+            return data;
+        }
+        if (reloader.joinable()) reloader.join();
+        reloading = true;
+        reloader = std::thread([this, version, startedAt = loads]() {
+            auto fresh = read();
+            std::lock_guard<std::mutex> lock(loadMutex);
+            if (fresh && loads == startedAt) install(std::move(fresh), version);
+            reloading = false;
+        });
+        return data;
+    }
+
+    const std::string& file() const {
+        return filename;
+    }
+
+    // Number of times the file has been read successfully.
+    size_t loadCount() const {
+        std::lock_guard<std::mutex> lock(loadMutex);
+        return loads;
+    }
+};
+
+#endif
@@ -2,229 +2,1255 @@
 #define STUDENT_REGISTRY_H
 
 #include "Student.h"
+#include "StudentArena.h"
+#include "GradeColumn.h"
+#include "ParallelMerge.h"
+#include "RadixSort.h"
+#include "MappedFile.h"
+#include "Snapshot.h"
+#include "Metrics.h"
+#include <atomic>
 #include <vector>
-#include <map>
-#include <set>
 #include <memory>
 #include <algorithm>
 #include <chrono>
 #include <thread>
 #include <mutex>
+#include <shared_mutex>
 #include <iterator>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <iostream>
+#include <limits>
 
+// Wall-clock time spent in each phase of StudentRegistry::parallelSort.
+struct SortPhaseTimes {
+    std::chrono::microseconds sort{0};
+    std::chrono::microseconds merge{0};
+    std::chrono::microseconds total{0};
+};
+
+// Algorithm StudentRegistry::parallelSort uses. Both produce the operator<
+// order; Radix only applies to string roll numbers and otherwise falls back
+// to Comparison.
+enum class SortEngine {
+    Comparison,
+    Radix
+};
+
+// Aggregates over the grades a course's index holds (each student's higher
+// of current and previous grade, rounded to 0.1). The grade fields are NaN
+// when the course has no grades.
+struct CourseStats {
+    size_t count = 0;
+    double mean = std::numeric_limits<double>::quiet_NaN();
+    double min = std::numeric_limits<double>::quiet_NaN();
+    double median = std::numeric_limits<double>::quiet_NaN();
+    // Lowest grade in the top 10% (the 90th percentile).
+    double topDecileCutoff = std::numeric_limits<double>::quiet_NaN();
+    double max = std::numeric_limits<double>::quiet_NaN();
+};
+
+// How StudentRegistry::matchGrades combines its conditions.
+enum class GradeMatch {
+    All,
+    Any
+};
+
+// Readers take registryMutex shared and writers take it exclusively. Orders
+// and grade columns are published as immutable shared snapshots that
+// iterators and views hold on to, so a writer replaces them instead of
+// editing them while a reader is still walking an older version.
 template<typename R, typename C>
 class StudentRegistry {
 private:
-    std::vector<std::shared_ptr<Student<R, C>>> originalOrder;
-    std::vector<std::shared_ptr<Student<R, C>>> sortedOrder;
-    std::map<C, std::map<double, std::set<std::shared_ptr<Student<R, C>>>>> courseGradeIndex;
-    mutable std::mutex registryMutex;
+    using HandleList = std::vector<StudentHandle>;
 
-public:
-    void addStudent(std::shared_ptr<Student<R, C>> student) {
-        std::lock_guard<std::mutex> lock(registryMutex);
-        
-        originalOrder.push_back(student);
-        sortedOrder.push_back(student);
-        std::sort(sortedOrder.begin(), sortedOrder.end(),
-                  [](const std::shared_ptr<Student<R, C>>& a,
-                     const std::shared_ptr<Student<R, C>>& b) {
-                      return *a < *b;
-                  });
-        
-        for (const auto& coursePair : student->getPreviousCourses()) {
-            courseGradeIndex[coursePair.first][coursePair.second].insert(student);
+    static constexpr StudentHandle liveHandle = UINT32_MAX;
+    static constexpr StudentHandle removedHandle = UINT32_MAX - 1;
+
+    StudentArena<R, C> students;
+    mutable std::shared_ptr<HandleList> originalOrder = std::make_shared<HandleList>();
+    // Set whenever originalOrder is handed to a reader, and cleared when the
+    // registry starts a fresh list. Written under the shared lock and read
+    // under the exclusive one, so the mutex orders the two.
+    mutable std::atomic<bool> originalShared{false};
+    mutable std::shared_ptr<const HandleList> sortedOrder = std::make_shared<const HandleList>();
+    mutable std::vector<StudentHandle> pendingSorted;
+    mutable std::vector<GradeColumn> courseGradeIndex;
+    mutable std::shared_mutex registryMutex;
+
+    // Every registryMutex acquisition goes through these so contended waits
+    // show up in Metrics.
+    std::unique_lock<std::shared_mutex> lockExclusive() const {
+        return Metrics::acquire<std::unique_lock<std::shared_mutex>>(registryMutex);
+    }
+
+    std::shared_lock<std::shared_mutex> lockShared() const {
+        return Metrics::acquire<std::shared_lock<std::shared_mutex>>(registryMutex);
+    }
+    
+    // Edits that keep a student's place in the sorted order replace its
+    // record under the same handle (see StudentArena::replace). A student
+    // whose roll number changes gets a new record and handle instead, and
+    // the old record stays in the arena for readers still holding it.
+    // nextVersion[h] is the record that replaced h, removedHandle if h was
+    // removed, or liveHandle (also implied past the end) if h is current.
+    // Both vectors are sized on the first roll-number change or removal.
+    std::vector<StudentHandle> nextVersion;
+    // Set on records replaced by a roll-number change: the new version was
+    // queued in pendingSorted, so h's place in the sorted order is void.
+    std::vector<bool> leftSortedPosition;
+    // Removals and replacements not yet applied to the order lists.
+    mutable bool ordersStale = false;
+    mutable size_t staleRemovals = 0;
+    // Retired records whose contents compactVersions() has not yet cleared.
+    std::vector<StudentHandle> retiredRecords;
+
+    StudentHandle storeStudent(const std::shared_ptr<Student<R, C>>& student) {
+        return students.emplace(*student);
+    }
+
+    StudentHandle storeStudent(const Student<R, C>& student) {
+        return students.emplace(student);
+    }
+
+    StudentHandle storeStudent(Student<R, C>&& student) {
+        return students.emplace(std::move(student));
+    }
+
+    // Copy-on-write: copy originalOrder before editing it if it has been
+    // handed to a reader since the registry last started a fresh list.
+    // Caller holds the lock exclusively.
+    void detachOriginalOrder() {
+        if (originalShared.exchange(false, std::memory_order_relaxed)) {
+            originalOrder = std::make_shared<HandleList>(*originalOrder);
+        }
+    }
+
+    // Returns originalOrder for a reader. Caller holds the lock, shared or
+    // exclusively.
+    std::shared_ptr<const HandleList> shareOriginalOrder() const {
+        originalShared.store(true, std::memory_order_relaxed);
+        return originalOrder;
+    }
+
+    // A student is posted once per course, under the higher of its current
+    // and previous grade, which is the grade a ">=" query has to match. NaN
+    // grades and default (noCourse) keys are not posted.
+    template<typename Fn>
+    static void forEachPosting(const Student<R, C>& student, Fn fn) {
+        auto post = [&fn](const CourseKey<C>& courseCode, double grade) {
+            if (std::isnan(grade)) return;
+            CourseId course = courseIdOf<C>(courseCode);
+            if (course != noCourse) fn(course, grade);
+        };
+        const auto& previous = student.getPreviousCourses();
+        const auto& current = student.getCurrentCourses();
+        for (const auto& coursePair : previous) {
+            double grade = coursePair.second;
+            auto currentIt = current.find(coursePair.first);
+            if (currentIt != current.end() && currentIt->second > grade) {
+                grade = currentIt->second;
+            }
+            post(coursePair.first, grade);
         }
-        for (const auto& coursePair : student->getCurrentCourses()) {
-            courseGradeIndex[coursePair.first][coursePair.second].insert(student);
+        for (const auto& coursePair : current) {
+            if (previous.count(coursePair.first) == 0) {
+                post(coursePair.first, coursePair.second);
+            }
         }
     }
 
-    std::vector<std::shared_ptr<Student<R, C>>> getStudentsWithGrade(
-            const C& courseCode, double minGrade) const {
-        std::lock_guard<std::mutex> lock(registryMutex);
+    // Caller holds the lock exclusively for these two.
+    void postGrades(StudentHandle handle) {
+        forEachPosting(students[handle], [this, handle](CourseId course, double grade) {
+            if (course >= courseGradeIndex.size()) {
+                courseGradeIndex.resize(course + 1);
+            }
+            courseGradeIndex[course].add(grade, handle);
+        });
+    }
+
+    void withdrawGrades(StudentHandle handle) {
+        forEachPosting(students[handle], [this, handle](CourseId course, double grade) {
+            if (course < courseGradeIndex.size()) {
+                courseGradeIndex[course].remove(grade, handle);
+            }
+        });
+    }
+
+    // Moves handle's postings from before's grades to those of its current
+    // record, touching only the courses whose posted grade changed, so the
+    // next flush copies only their buckets. Caller holds the lock
+    // exclusively.
+    void repostGrades(StudentHandle handle, const Student<R, C>& before) {
+        using Posting = std::pair<CourseId, double>;
+        auto postingsOf = [](const Student<R, C>& student) {
+            std::vector<Posting> postings;
+            forEachPosting(student, [&postings](CourseId course, double grade) {
+                postings.emplace_back(course, grade);
+            });
+            return postings;
+        };
+        std::vector<Posting> previous = postingsOf(before);
+        std::vector<Posting> current = postingsOf(students[handle]);
+        auto holds = [](const std::vector<Posting>& postings, const Posting& posting) {
+            return std::find(postings.begin(), postings.end(), posting) != postings.end();
+        };
+        for (const Posting& posting : previous) {
+            if (!holds(current, posting) && posting.first < courseGradeIndex.size()) {
+                courseGradeIndex[posting.first].remove(posting.second, handle);
+            }
+        }
+        for (const Posting& posting : current) {
+            if (holds(previous, posting)) continue;
+            if (posting.first >= courseGradeIndex.size()) {
+                courseGradeIndex.resize(posting.first + 1);
+            }
+            courseGradeIndex[posting.first].add(posting.second, handle);
+        }
+    }
+
+    // Caller holds the lock exclusively and has detached originalOrder.
+    void indexStudent(StudentHandle handle) {
+        originalOrder->push_back(handle);
+        pendingSorted.push_back(handle);
+        postGrades(handle);
+    }
+
+    StudentHandle successorOf(StudentHandle handle) const {
+        return handle < nextVersion.size() ? nextVersion[handle] : liveHandle;
+    }
+
+    // The current record of the student handle names (handle itself unless
+    // the student was updated), or nullopt if it was removed.
+    std::optional<StudentHandle> currentVersion(StudentHandle handle) const {
+        if (handle >= students.size()) return std::nullopt;
+        for (StudentHandle next = successorOf(handle); next != liveHandle;
+             next = successorOf(handle)) {
+            if (next == removedHandle) return std::nullopt;
+            handle = next;
+        }
+        return handle;
+    }
+
+    // Whether handle's place in the sorted order is still where its current
+    // version belongs (it was neither removed nor given a new roll number).
+    bool keepsSortedPosition(StudentHandle handle) const {
+        for (StudentHandle next = successorOf(handle); next != liveHandle;
+             next = successorOf(handle)) {
+            if (next == removedHandle || leftSortedPosition[handle]) return false;
+            handle = next;
+        }
+        return true;
+    }
+
+    // Caller holds the lock exclusively.
+    void retire(StudentHandle handle, StudentHandle next, bool leavesSortedPosition) {
+        if (nextVersion.size() < students.size()) {
+            nextVersion.resize(students.size(), liveHandle);
+            leftSortedPosition.resize(students.size(), false);
+        }
+        nextVersion[handle] = next;
+        leftSortedPosition[handle] = leavesSortedPosition;
+        retiredRecords.push_back(handle);
+        ordersStale = true;
+    }
+
+    // Replaces the current version of a student with an edited copy. If the
+    // edit keeps its place in the sorted order the copy takes over the same
+    // handle, and only the postings of changed courses move; the order lists
+    // are untouched. Otherwise the copy gets a new handle and the order lists
+    // catch up lazily. edit returns false if it changed nothing, in which
+    // case no new version is made. Caller holds the lock exclusively.
+    template<typename Edit>
+    std::optional<StudentHandle> replaceStudent(StudentHandle handle, bool movesInSortedOrder,
+                                                Edit edit) {
+        auto current = currentVersion(handle);
+        if (!current) return std::nullopt;
+        Student<R, C> updated = students[*current];
+        if (!edit(updated)) return current;
         
-        std::set<std::shared_ptr<Student<R, C>>> resultSet;
+        if (!movesInSortedOrder) {
+            // The superseded record stays readable until compactVersions().
+            const Student<R, C>& before = students[*current];
+            students.replace(*current, std::move(updated));
+            repostGrades(*current, before);
+            return current;
+        }
+        withdrawGrades(*current);
+        StudentHandle next = students.emplace(std::move(updated));
+        retire(*current, next, true);
+        postGrades(next);
+        pendingSorted.push_back(next);
+        return next;
+    }
+
+    static bool setGrade(Student<R, C>& student, const C& courseCode, double grade) {
+        CourseKey<C> key(courseCode);
+        bool isCurrent = student.getPreviousCourses().count(key) == 0 &&
+                         student.getCurrentCourses().count(key) != 0;
+        const auto& courses = isCurrent ? student.getCurrentCourses()
+                                        : student.getPreviousCourses();
+        auto it = courses.find(key);
+        if (it != courses.end() && it->second == grade) return false;
+        if (isCurrent) {
+            student.addCurrentCourse(key, grade);
+        } else {
+            student.addPreviousCourse(key, grade);
+        }
+        return true;
+    }
+
+    // Rewrites the order lists without removed students and with replaced
+    // ones swapped for their current version, in one O(n) pass however many
+    // edits are pending. Caller holds the lock exclusively.
+    void refreshOrders() const {
+        if (!ordersStale) return;
         
-        auto courseIt = courseGradeIndex.find(courseCode);
-        if (courseIt == courseGradeIndex.end()) {
-            return std::vector<std::shared_ptr<Student<R, C>>>();
+        auto original = std::make_shared<HandleList>();
+        original->reserve(originalOrder->size() - staleRemovals);
+        for (StudentHandle handle : *originalOrder) {
+            if (auto current = currentVersion(handle)) original->push_back(*current);
         }
+        auto sorted = std::make_shared<HandleList>();
+        sorted->reserve(sortedOrder->size());
+        for (StudentHandle handle : *sortedOrder) {
+            if (keepsSortedPosition(handle)) sorted->push_back(*currentVersion(handle));
+        }
+        pendingSorted.erase(std::remove_if(pendingSorted.begin(), pendingSorted.end(),
+                                           [this](StudentHandle handle) {
+                                               return !keepsSortedPosition(handle);
+                                           }),
+                            pendingSorted.end());
+        for (StudentHandle& handle : pendingSorted) {
+            handle = *currentVersion(handle);
+        }
+        originalOrder = std::move(original);
+        originalShared.store(false, std::memory_order_relaxed);
+        sortedOrder = std::move(sorted);
+        ordersStale = false;
+        staleRemovals = 0;
+    }
+
+    // New students are kept in an unsorted run and merged into a new sorted
+    // order only when the sorted view is next read, so a load of k students
+    // costs O(k log k + n) instead of a full sort per insert. Caller holds
+    // the lock exclusively.
+    void mergePendingSorted() const {
+        if (pendingSorted.empty()) return;
         
-        for (auto gradeIt = courseIt->second.lower_bound(minGrade);
-             gradeIt != courseIt->second.end(); ++gradeIt) {
-            for (const auto& student : gradeIt->second) {
-                resultSet.insert(student);
+        auto lessByRollNumber = [this](StudentHandle a, StudentHandle b) {
+            return students[a] < students[b];
+        };
+        std::stable_sort(pendingSorted.begin(), pendingSorted.end(), lessByRollNumber);
+        auto merged = std::make_shared<HandleList>();
+        merged->reserve(sortedOrder->size() + pendingSorted.size());
+        std::merge(sortedOrder->begin(), sortedOrder->end(),
+                   pendingSorted.begin(), pendingSorted.end(),
+                   std::back_inserter(*merged), lessByRollNumber);
+        pendingSorted.clear();
+        sortedOrder = std::move(merged);
+    }
+
+    std::shared_ptr<const HandleList> originalSnapshot() const {
+        {
+            auto lock = lockShared();
+            if (!ordersStale) return shareOriginalOrder();
+        }
+        auto lock = lockExclusive();
+        refreshOrders();
+        return shareOriginalOrder();
+    }
+
+    std::shared_ptr<const HandleList> sortedSnapshot() const {
+        {
+            auto lock = lockShared();
+            if (pendingSorted.empty() && !ordersStale) return sortedOrder;
+        }
+        auto lock = lockExclusive();
+        refreshOrders();
+        mergePendingSorted();
+        return sortedOrder;
+    }
+
+    std::shared_ptr<const GradeColumn::Postings> columnSnapshot(CourseId course) const {
+        {
+            auto lock = lockShared();
+            if (course >= courseGradeIndex.size()) return nullptr;
+            if (!courseGradeIndex[course].hasPending()) return courseGradeIndex[course].snapshot();
+        }
+        auto lock = lockExclusive();
+        courseGradeIndex[course].flush();
+        return courseGradeIndex[course].snapshot();
+    }
+
+    // Snapshots of several columns (null for unknown courses) and the original
+    // order, all taken under one lock so they describe the same moment.
+    std::vector<std::shared_ptr<const GradeColumn::Postings>> columnSnapshots(
+            const std::vector<std::optional<CourseId>>& courses,
+            std::shared_ptr<const HandleList>& original) const {
+        std::vector<std::shared_ptr<const GradeColumn::Postings>> columns(courses.size());
+        auto collect = [&]() {
+            for (size_t i = 0; i < courses.size(); ++i) {
+                if (courses[i] && *courses[i] < courseGradeIndex.size()) {
+                    columns[i] = courseGradeIndex[*courses[i]].snapshot();
+                }
+            }
+            original = shareOriginalOrder();
+        };
+        auto hasPending = [&]() {
+            return std::any_of(courses.begin(), courses.end(), [this](const auto& course) {
+                return course && *course < courseGradeIndex.size() &&
+                       courseGradeIndex[*course].hasPending();
+            });
+        };
+        {
+            auto lock = lockShared();
+            if (!hasPending() && !ordersStale) {
+                collect();
+                return columns;
             }
         }
-        
-        std::vector<std::shared_ptr<Student<R, C>>> result(resultSet.begin(), resultSet.end());
-        return result;
+        auto lock = lockExclusive();
+        refreshOrders();
+        for (const auto& course : courses) {
+            if (course && *course < courseGradeIndex.size()) {
+                courseGradeIndex[*course].flush();
+            }
+        }
+        collect();
+        return columns;
     }
 
-    class OriginalOrderIterator {
-        typename std::vector<std::shared_ptr<Student<R, C>>>::const_iterator it;
+    // Iterator over a pinned snapshot of handles. Any iterator that has
+    // walked off the end of its snapshot compares equal to any end iterator,
+    // so begin() and end() obtained by separate calls still terminate.
+    template<typename Tag>
+    class HandleIterator {
+        std::shared_ptr<const HandleList> handles;
+        size_t index;
+        const StudentArena<R, C>* arena;
+
+        bool atEnd() const {
+            return index >= handles->size();
+        }
 
     public:
         using iterator_category = std::forward_iterator_tag;
-        using value_type = std::shared_ptr<Student<R, C>>;
+        using value_type = const Student<R, C>*;
         using difference_type = std::ptrdiff_t;
-        using pointer = std::shared_ptr<Student<R, C>>*;
-        using reference = std::shared_ptr<Student<R, C>>;
+        using pointer = const Student<R, C>*;
+        using reference = const Student<R, C>*;
 
-        OriginalOrderIterator(typename std::vector<std::shared_ptr<Student<R, C>>>::const_iterator it)
-            : it(it) {}
+        HandleIterator(std::shared_ptr<const HandleList> handles, size_t index,
+                       const StudentArena<R, C>* arena)
+            : handles(std::move(handles)), index(index), arena(arena) {}
 
-        OriginalOrderIterator& operator++() {
-            ++it;
+        HandleIterator& operator++() {
+            ++index;
             return *this;
         }
 
-        OriginalOrderIterator operator++(int) {
-            OriginalOrderIterator tmp = *this;
-            ++it;
+        HandleIterator operator++(int) {
+            HandleIterator tmp = *this;
+            ++index;
             return tmp;
         }
 
-        bool operator==(const OriginalOrderIterator& other) const {
-            return it == other.it;
+        bool operator==(const HandleIterator& other) const {
+            if (atEnd() || other.atEnd()) return atEnd() && other.atEnd();
+            return index == other.index && handles == other.handles;
         }
 
-        bool operator!=(const OriginalOrderIterator& other) const {
-            return it != other.it;
+        bool operator!=(const HandleIterator& other) const {
+            return !(*this == other);
         }
 
-        std::shared_ptr<Student<R, C>> operator*() const {
-            return *it;
+        const Student<R, C>* operator*() const {
+            return &(*arena)[(*handles)[index]];
         }
 
-        std::shared_ptr<Student<R, C>> operator->() const {
-            return *it;
+        const Student<R, C>* operator->() const {
+            return &(*arena)[(*handles)[index]];
+        }
+
+        StudentHandle handle() const {
+            return (*handles)[index];
         }
     };
 
-    OriginalOrderIterator originalBegin() const {
-        return OriginalOrderIterator(originalOrder.begin());
+    struct OriginalTag {};
+    struct SortedTag {};
+
+public:
+    using OriginalOrderIterator = HandleIterator<OriginalTag>;
+    using SortedOrderIterator = HandleIterator<SortedTag>;
+
+    // One consistent snapshot of an order; begin() and end() share it.
+    template<typename Iterator>
+    class OrderView {
+        std::shared_ptr<const HandleList> handles;
+        const StudentArena<R, C>* arena;
+
+    public:
+        OrderView(std::shared_ptr<const HandleList> handles, const StudentArena<R, C>* arena)
+            : handles(std::move(handles)), arena(arena) {}
+
+        Iterator begin() const { return Iterator(handles, 0, arena); }
+        Iterator end() const { return Iterator(handles, handles->size(), arena); }
+        size_t size() const { return handles->size(); }
+        bool empty() const { return handles->empty(); }
+    };
+
+    // Slice of a course's grade column, highest grade first (ties by
+    // handle). The range keeps its snapshot of the column alive, so it stays
+    // valid and unchanged while the registry is modified; its iterators are
+    // valid while the range is.
+    class GradeRange {
+        std::shared_ptr<const GradeColumn::Postings> postings;
+        size_t bucketCount;
+        size_t count;
+        const StudentArena<R, C>* arena;
+
+        const GradeBucket* buckets() const {
+            return postings ? postings->buckets.data() : nullptr;
+        }
+
+    public:
+        class iterator {
+            const GradeBucket* bucket;
+            const GradeBucket* last;
+            RoaringBitmap::const_iterator it;
+            RoaringBitmap::const_iterator stop;
+            const StudentArena<R, C>* arena;
+
+            void enterBucket() {
+                while (bucket != last && bucket->students->empty()) ++bucket;
+                if (bucket != last) {
+                    it = bucket->students->begin();
+                    stop = bucket->students->end();
+                } else {
+                    it = stop = RoaringBitmap::const_iterator();
+                }
+            }
+
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = const Student<R, C>*;
+            using difference_type = std::ptrdiff_t;
+            using pointer = const Student<R, C>*;
+            using reference = const Student<R, C>*;
+
+            iterator(const GradeBucket* bucket, const GradeBucket* last,
+                     const StudentArena<R, C>* arena)
+                : bucket(bucket), last(last), arena(arena) {
+                enterBucket();
+            }
+
+            iterator& operator++() {
+                if (++it == stop) {
+                    ++bucket;
+                    enterBucket();
+                }
+                return *this;
+            }
+
+            iterator operator++(int) {
+                iterator tmp = *this;
+                ++*this;
+                return tmp;
+            }
+
+            bool operator==(const iterator& other) const {
+                return bucket == other.bucket && it == other.it;
+            }
+
+            bool operator!=(const iterator& other) const {
+                return !(*this == other);
+            }
+
+            const Student<R, C>* operator*() const {
+                return &(*arena)[*it];
+            }
+
+            const Student<R, C>* operator->() const {
+                return &(*arena)[*it];
+            }
+
+            double grade() const {
+                return bucket->grade;
+            }
+
+            StudentHandle handle() const {
+                return *it;
+            }
+        };
+
+        GradeRange(std::shared_ptr<const GradeColumn::Postings> postings, double minGrade,
+                   const StudentArena<R, C>* arena)
+            : postings(std::move(postings)), bucketCount(0), count(0), arena(arena) {
+            if (this->postings) {
+                bucketCount = this->postings->bucketsAtLeast(minGrade);
+                count = this->postings->prefixCounts[bucketCount];
+            }
+        }
+
+        iterator begin() const { return iterator(buckets(), buckets() + bucketCount, arena); }
+        iterator end() const {
+            return iterator(buckets() + bucketCount, buckets() + bucketCount, arena);
+        }
+        size_t size() const { return count; }
+        bool empty() const { return count == 0; }
+    };
+
+    StudentRegistry() = default;
+    StudentRegistry(const StudentRegistry&) = delete;
+    StudentRegistry& operator=(const StudentRegistry&) = delete;
+
+    StudentHandle addStudent(const std::shared_ptr<Student<R, C>>& student) {
+        auto lock = lockExclusive();
+        detachOriginalOrder();
+        StudentHandle handle = storeStudent(student);
+        indexStudent(handle);
+        return handle;
     }
 
-    OriginalOrderIterator originalEnd() const {
-        return OriginalOrderIterator(originalOrder.end());
+    StudentHandle addStudent(Student<R, C> student) {
+        auto lock = lockExclusive();
+        detachOriginalOrder();
+        StudentHandle handle = storeStudent(std::move(student));
+        indexStudent(handle);
+        return handle;
     }
 
-    class SortedOrderIterator {
-        typename std::vector<std::shared_ptr<Student<R, C>>>::const_iterator it;
+    template<typename InputIt>
+    void addStudents(InputIt first, InputIt last) {
+        auto lock = lockExclusive();
+        detachOriginalOrder();
+        for (; first != last; ++first) {
+            indexStudent(storeStudent(*first));
+        }
+    }
 
-    public:
-        using iterator_category = std::forward_iterator_tag;
-        using value_type = std::shared_ptr<Student<R, C>>;
-        using difference_type = std::ptrdiff_t;
-        using pointer = std::shared_ptr<Student<R, C>>*;
-        using reference = std::shared_ptr<Student<R, C>>;
+    template<typename Range>
+    void addStudents(const Range& batch) {
+        addStudents(std::begin(batch), std::end(batch));
+    }
 
-        SortedOrderIterator(typename std::vector<std::shared_ptr<Student<R, C>>>::const_iterator it)
-            : it(it) {}
+    // The current record behind handle. Grade edits keep the handle, so this
+    // sees them; after a roll-number change or removal it is the version
+    // handle was issued for, and currentHandle gives the latest one. The
+    // reference stays valid until compactVersions().
+    const Student<R, C>& getStudent(StudentHandle handle) const {
+        return students[handle];
+    }
 
-        SortedOrderIterator& operator++() {
-            ++it;
-            return *this;
+    // Handle of the current version of the student handle names, or nullopt
+    // if the student was removed.
+    std::optional<StudentHandle> currentHandle(StudentHandle handle) const {
+        auto lock = lockShared();
+        return currentVersion(handle);
+    }
+
+    // The update operations below accept any handle a student has had and
+    // return the handle of its current version (or nullopt if the student
+    // was removed). Grade edits keep the handle and leave the order lists
+    // alone; the changed postings move at the next read of their column,
+    // which copies only the grade buckets they touch. A roll-number change
+    // or removal retires the handle, and the order lists are rewritten once,
+    // on their next read, for any number of those: O(n) per rewrite, so
+    // they are cheap in batches, but a removal or roll-number change
+    // between every two ordered reads costs O(n) each. Superseded records
+    // stay readable for views, iterators and references that hold them
+    // until compactVersions().
+
+    // Removes the student. Returns false if it was already removed.
+    bool removeStudent(StudentHandle handle) {
+        auto lock = lockExclusive();
+        auto current = currentVersion(handle);
+        if (!current) return false;
+        withdrawGrades(*current);
+        retire(*current, removedHandle, true);
+        staleRemovals++;
+        return true;
+    }
+
+    // Sets the student's grade in a course: the previous grade if the course
+    // was completed, else the current grade if it is being taken, else the
+    // course is added as completed with this grade.
+    std::optional<StudentHandle> updateGrade(StudentHandle handle, const C& courseCode,
+                                             double grade) {
+        auto lock = lockExclusive();
+        return replaceStudent(handle, false, [&](Student<R, C>& student) {
+            return setGrade(student, courseCode, grade);
+        });
+    }
+
+    struct GradeUpdate {
+        StudentHandle student;
+        C course;
+        double grade;
+    };
+
+    // updateGrade for a whole batch (e.g. term-end grade posting) under one
+    // lock. Returns how many students were found; updates naming a removed
+    // student are skipped.
+    size_t updateGrades(const std::vector<GradeUpdate>& updates) {
+        auto lock = lockExclusive();
+        size_t applied = 0;
+        for (const GradeUpdate& update : updates) {
+            applied += replaceStudent(update.student, false, [&](Student<R, C>& student) {
+                return setGrade(student, update.course, update.grade);
+            }).has_value();
         }
+        return applied;
+    }
 
-        SortedOrderIterator operator++(int) {
-            SortedOrderIterator tmp = *this;
-            ++it;
-            return tmp;
+    // Moves a current course to the student's previous courses, keeping its
+    // grade; a course the student is not taking is left alone.
+    std::optional<StudentHandle> completeCourse(StudentHandle handle, const C& courseCode) {
+        auto lock = lockExclusive();
+        return replaceStudent(handle, false, [&](Student<R, C>& student) {
+            size_t before = student.getCurrentCourses().size();
+            student.completeCourse(courseCode);
+            return student.getCurrentCourses().size() != before;
+        });
+    }
+
+    std::optional<StudentHandle> changeRollNumber(StudentHandle handle, const R& rollNumber) {
+        auto lock = lockExclusive();
+        auto current = currentVersion(handle);
+        if (!current || students[*current].getRollNumber() == rollNumber) return current;
+        return replaceStudent(*current, true, [&](Student<R, C>& student) {
+            student.setRollNumber(rollNumber);
+            return true;
+        });
+    }
+
+    // Reclaims the records superseded by grade edits and clears those of
+    // removed students and of handles retired by roll-number changes, so
+    // memory goes back to one record per student. Every view, iterator,
+    // range and student reference obtained before the call is invalidated,
+    // and no other thread may use the registry while it runs. Returns the
+    // number of records reclaimed.
+    size_t compactVersions() {
+        auto lock = lockExclusive();
+        refreshOrders();
+        size_t reclaimed = students.supersededCount() + retiredRecords.size();
+        students.compact();
+        for (StudentHandle handle : retiredRecords) {
+            students.clear(handle);
         }
+        retiredRecords.clear();
+        retiredRecords.shrink_to_fit();
+        return reclaimed;
+    }
 
-        bool operator==(const SortedOrderIterator& other) const {
-            return it == other.it;
+    GradeRange gradeRange(const C& courseCode, double minGrade) const {
+        Metrics::ScopedTimer timer(Metrics::instance().gradeRanges());
+        auto course = findCourseId(courseCode);
+        std::shared_ptr<const GradeColumn::Postings> postings;
+        if (course) {
+            postings = columnSnapshot(*course);
         }
+        return GradeRange(std::move(postings), minGrade, &students);
+    }
 
-        bool operator!=(const SortedOrderIterator& other) const {
-            return it != other.it;
+    std::vector<const Student<R, C>*> getStudentsWithGrade(
+            const C& courseCode, double minGrade) const {
+        Metrics::ScopedTimer timer(Metrics::instance().gradeQueries());
+        GradeRange range = gradeRange(courseCode, minGrade);
+        std::vector<const Student<R, C>*> result;
+        result.reserve(range.size());
+        for (const Student<R, C>* student : range) {
+            result.push_back(student);
         }
+        return result;
+    }
 
-        std::shared_ptr<Student<R, C>> operator*() const {
-            return *it;
+    // Count, mean, median and percentile cutoffs of a course's grades. The
+    // grade index keeps a per-grade histogram and a running sum, so this is
+    // O(log) in the number of grade buckets rather than a scan.
+    CourseStats courseStats(const C& courseCode) const {
+        auto course = findCourseId(courseCode);
+        std::shared_ptr<const GradeColumn::Postings> postings;
+        if (course) {
+            postings = columnSnapshot(*course);
         }
+        CourseStats stats;
+        if (!postings || postings->size() == 0) return stats;
+        stats.count = postings->size();
+        stats.mean = postings->mean();
+        stats.min = postings->percentile(0.0);
+        stats.median = postings->percentile(50.0);
+        stats.topDecileCutoff = postings->percentile(90.0);
+        stats.max = postings->percentile(100.0);
+        return stats;
+    }
 
-        std::shared_ptr<Student<R, C>> operator->() const {
-            return *it;
+    // Nearest-rank percentile (0-100) of a course's grades; NaN for an
+    // unknown course, a course without grades, or percent out of range.
+    double gradePercentile(const C& courseCode, double percent) const {
+        auto course = findCourseId(courseCode);
+        std::shared_ptr<const GradeColumn::Postings> postings;
+        if (course) {
+            postings = columnSnapshot(*course);
         }
+        return postings ? postings->percentile(percent)
+                        : std::numeric_limits<double>::quiet_NaN();
+    }
+
+    struct GradeCondition {
+        C course;
+        double minGrade;
     };
 
+    // Handles, in ascending order, of the students whose grade in every
+    // (GradeMatch::All) or at least one (GradeMatch::Any) of the courses is
+    // >= its minGrade. All columns are read from one consistent snapshot.
+    // Each condition's qualifying grade buckets are unioned into one bitmap
+    // by its own pool task, then the bitmaps are intersected or unioned.
+    // With no conditions, All matches every student and Any matches none.
+    std::vector<StudentHandle> matchGrades(const std::vector<GradeCondition>& conditions,
+                                           GradeMatch match) const {
+        Metrics::ScopedTimer timer(Metrics::instance().multiGradeQueries());
+        std::vector<std::optional<CourseId>> courses;
+        for (const auto& condition : conditions) {
+            courses.push_back(findCourseId(condition.course));
+        }
+        std::shared_ptr<const HandleList> original;
+        auto columns = columnSnapshots(courses, original);
+        
+        if (conditions.empty()) {
+            std::vector<StudentHandle> handles;
+            if (match == GradeMatch::All) {
+                handles.assign(original->begin(), original->end());
+                std::sort(handles.begin(), handles.end());
+            }
+            return handles;
+        }
+        
+        std::vector<RoaringBitmap> bitmaps(conditions.size());
+        {
+            TaskGroup group;
+            for (size_t i = 0; i < conditions.size(); ++i) {
+                group.run([&, i]() {
+                    if (columns[i]) {
+                        bitmaps[i] = columns[i]->studentsAtLeast(conditions[i].minGrade);
+                    }
+                });
+            }
+            group.wait();
+        }
+        
+        if (match == GradeMatch::Any) {
+            std::vector<const RoaringBitmap*> parts;
+            for (const auto& bitmap : bitmaps) {
+                parts.push_back(&bitmap);
+            }
+            return RoaringBitmap::unionOf(parts).toVector();
+        }
+        
+        // Intersect smallest first so the running result shrinks early.
+        std::sort(bitmaps.begin(), bitmaps.end(),
+                  [](const RoaringBitmap& a, const RoaringBitmap& b) {
+                      return a.cardinality() < b.cardinality();
+                  });
+        RoaringBitmap result = std::move(bitmaps[0]);
+        for (size_t i = 1; i < bitmaps.size() && !result.empty(); ++i) {
+            result &= bitmaps[i];
+        }
+        return result.toVector();
+    }
+
+    // The student with this roll number, or null; with duplicate roll
+    // numbers, the first in sorted order. A binary search of the sorted
+    // order.
+    const Student<R, C>* findByRollNumber(const R& rollNumber) const {
+        auto handles = sortedSnapshot();
+        Student<R, C> probe("", rollNumber, "", 0);
+        auto it = std::lower_bound(handles->begin(), handles->end(), probe,
+                                   [this](StudentHandle handle, const Student<R, C>& key) {
+                                       return students[handle] < key;
+                                   });
+        if (it == handles->end() || probe < students[*it]) return nullptr;
+        return &students[*it];
+    }
+
+    // Students whose roll numbers lie in [from, to] in sorted (natural)
+    // order, at most limit of them, from one snapshot of the sorted order.
+    // total (if given) receives the number in the range before the limit.
+    std::vector<const Student<R, C>*> studentsInRollRange(const R& from, const R& to,
+                                                          size_t limit = SIZE_MAX,
+                                                          size_t* total = nullptr) const {
+        auto handles = sortedSnapshot();
+        Student<R, C> low("", from, "", 0);
+        Student<R, C> high("", to, "", 0);
+        auto first = std::lower_bound(handles->begin(), handles->end(), low,
+                                      [this](StudentHandle handle, const Student<R, C>& key) {
+                                          return students[handle] < key;
+                                      });
+        auto last = std::upper_bound(first, handles->end(), high,
+                                     [this](const Student<R, C>& key, StudentHandle handle) {
+                                         return key < students[handle];
+                                     });
+        size_t count = static_cast<size_t>(last - first);
+        if (total) *total = count;
+        std::vector<const Student<R, C>*> result;
+        result.reserve(std::min(count, limit));
+        for (auto it = first; result.size() < std::min(count, limit); ++it) {
+            result.push_back(&students[*it]);
+        }
+        return result;
+    }
+
+    OrderView<OriginalOrderIterator> originalView() const {
+        return OrderView<OriginalOrderIterator>(originalSnapshot(), &students);
+    }
+
+    OrderView<SortedOrderIterator> sortedView() const {
+        return OrderView<SortedOrderIterator>(sortedSnapshot(), &students);
+    }
+
+    OriginalOrderIterator originalBegin() const {
+        return OriginalOrderIterator(originalSnapshot(), 0, &students);
+    }
+
+    OriginalOrderIterator originalEnd() const {
+        auto handles = originalSnapshot();
+        size_t end = handles->size();
+        return OriginalOrderIterator(std::move(handles), end, &students);
+    }
+
     SortedOrderIterator sortedBegin() const {
-        return SortedOrderIterator(sortedOrder.begin());
+        return SortedOrderIterator(sortedSnapshot(), 0, &students);
     }
 
     SortedOrderIterator sortedEnd() const {
-        return SortedOrderIterator(sortedOrder.end());
+        auto handles = sortedSnapshot();
+        size_t end = handles->size();
+        return SortedOrderIterator(std::move(handles), end, &students);
     }
 
     size_t size() const {
-        return originalOrder.size();
+        auto lock = lockShared();
+        return originalOrder->size() - staleRemovals;
     }
-
-    static void parallelSort(std::vector<std::shared_ptr<Student<R, C>>>& students,
-                            int numThreads, 
-                            std::vector<std::chrono::microseconds>& threadTimes) {
-        if (students.empty()) return;
-        
-        size_t chunkSize = students.size() / numThreads;
-        if (chunkSize == 0) chunkSize = 1;
-        
-        std::vector<std::thread> threads;
-        std::vector<std::vector<std::shared_ptr<Student<R, C>>>> chunks(numThreads);
-        threadTimes.resize(numThreads);
-        
-        for (int i = 0; i < numThreads; ++i) {
-            size_t start = i * chunkSize;
-            size_t end = (i == numThreads - 1) ? students.size() : (i + 1) * chunkSize;
-            chunks[i].assign(students.begin() + start, students.begin() + end);
-        }
-        
-        for (int i = 0; i < numThreads; ++i) {
-            threads.emplace_back([&chunks, &threadTimes, i]() {
-                auto startTime = std::chrono::high_resolution_clock::now();
-                
-                std::sort(chunks[i].begin(), chunks[i].end(),
-                         [](const std::shared_ptr<Student<R, C>>& a,
-                            const std::shared_ptr<Student<R, C>>& b) {
-                             return *a < *b;
-                         });
-                
-                auto endTime = std::chrono::high_resolution_clock::now();
-                threadTimes[i] = std::chrono::duration_cast<std::chrono::microseconds>(
-                    endTime - startTime);
-            });
+    
+    // Writes the students, the course codes, the sorted order and the grade
+    // index to filename in the format described in Snapshot.h. Returns false
+    // if the file could not be written.
+    bool saveSnapshot(const std::string& filename) const {
+        std::shared_ptr<const HandleList> original;
+        std::shared_ptr<const HandleList> sorted;
+        std::vector<std::shared_ptr<const GradeColumn::Postings>> columns;
+        size_t recordCount = 0;
+        SnapshotWriter out;
+        {
+            auto lock = lockExclusive();
+            refreshOrders();
+            mergePendingSorted();
+            for (auto& column : courseGradeIndex) {
+                column.flush();
+                columns.push_back(column.snapshot());
+            }
+            original = shareOriginalOrder();
+            sorted = sortedOrder;
+            recordCount = students.size();
         }
         
-        for (auto& thread : threads) {
-            thread.join();
+        // Records left behind by updates and removals are not written. The
+        // live ones are renumbered in handle order, which keeps every grade
+        // bucket in ascending handle order.
+        std::vector<StudentHandle> live;
+        std::vector<StudentHandle> renumbered;
+        if (original->size() != recordCount) {
+            live.assign(original->begin(), original->end());
+            std::sort(live.begin(), live.end());
+            renumbered.assign(recordCount, 0);
+            for (size_t i = 0; i < live.size(); ++i) {
+                renumbered[live[i]] = static_cast<StudentHandle>(i);
+            }
         }
+        auto recordAt = [&live](size_t i) {
+            return live.empty() ? static_cast<StudentHandle>(i) : live[i];
+        };
+        auto fileHandle = [&renumbered](StudentHandle handle) {
+            return renumbered.empty() ? handle : renumbered[handle];
+        };
+        auto putHandles = [&](const HandleList& handles) {
+            if (renumbered.empty()) {
+                out.putArray(handles.data(), handles.size());
+                return;
+            }
+            for (StudentHandle handle : handles) {
+                out.put(fileHandle(handle));
+            }
+        };
         
-        std::vector<std::shared_ptr<Student<R, C>>> result;
-        std::vector<size_t> indices(numThreads, 0);
+        const CourseTable<C>& courses = CourseTable<C>::instance();
+        SnapshotHeader header{};
+        std::memcpy(header.magic, SnapshotHeader::expectedMagic, sizeof(header.magic));
+        header.version = SnapshotHeader::currentVersion;
+        header.keyTypes = snapshotTypeTag<R>() | (snapshotTypeTag<C>() << 16);
+        header.studentCount = original->size();
+        header.courseCount = courses.size();
         
-        while (result.size() < students.size()) {
-            int bestChunk = -1;
-            std::shared_ptr<Student<R, C>> bestStudent = nullptr;
-            
-            for (int i = 0; i < numThreads; ++i) {
-                if (indices[i] < chunks[i].size()) {
-                    if (bestChunk == -1 || *chunks[i][indices[i]] < *bestStudent) {
-                        bestChunk = i;
-                        bestStudent = chunks[i][indices[i]];
-                    }
+        out.put(header);
+        out.align();
+        header.coursesOffset = out.position();
+        for (CourseId id = 0; id < header.courseCount; ++id) {
+            out.putValue(courses.code(id));
+        }
+        
+        out.align();
+        header.recordOffsetsOffset = out.position();
+        for (size_t i = 0; i < original->size(); ++i) {
+            out.put(uint64_t(0));
+        }
+        auto putCourses = [&out](const typename Student<R, C>::CourseMap& map) {
+            for (const auto& coursePair : map) {
+                out.put(static_cast<uint32_t>(courseIdOf<C>(coursePair.first)));
+                out.put(coursePair.second);
+            }
+        };
+        for (size_t i = 0; i < original->size(); ++i) {
+            out.patch(header.recordOffsetsOffset + i * sizeof(uint64_t),
+                      static_cast<uint64_t>(out.position()));
+            const Student<R, C>& student = students[recordAt(i)];
+            out.putString(student.getName());
+            out.putValue(student.getRollNumber());
+            out.putString(student.getBranch());
+            out.put(static_cast<int32_t>(student.getStartingYear()));
+            out.put(static_cast<uint32_t>(student.getCurrentCourses().size()));
+            out.put(static_cast<uint32_t>(student.getPreviousCourses().size()));
+            putCourses(student.getCurrentCourses());
+            putCourses(student.getPreviousCourses());
+        }
+        
+        out.align();
+        header.originalOrderOffset = out.position();
+        putHandles(*original);
+        out.align();
+        header.sortedOrderOffset = out.position();
+        putHandles(*sorted);
+        
+        out.align();
+        header.gradeIndexOffset = out.position();
+        out.put(static_cast<uint64_t>(columns.size()));
+        for (const auto& column : columns) {
+            out.put(static_cast<uint64_t>(column->size()));
+            for (const GradeBucket& bucket : column->buckets) {
+                for (StudentHandle handle : *bucket.students) {
+                    out.put(bucket.grade);
+                    out.put(fileHandle(handle));
+                    out.put(uint32_t(0));
                 }
             }
+        }
+        
+        header.fileSize = out.position();
+        out.patch(0, header);
+        if (!out.writeTo(filename)) {
+            std::cerr << "Error: Could not write snapshot " << filename << std::endl;
+            return false;
+        }
+        return true;
+    }
+    
+    // Fills an empty registry from a snapshot written by saveSnapshot. The
+    // sorted order and grade index are taken from the file as they are, so
+    // nothing is re-sorted or re-indexed. Returns false and leaves the
+    // registry unchanged if it is not empty, or if the file is missing,
+    // truncated, or was written by another version or for other key types.
+    bool loadSnapshot(const std::string& filename) {
+        static_assert(sizeof(GradeEntry) == 16 && offsetof(GradeEntry, handle) == 8,
+                      "grade index entries are stored as 16-byte records");
+        
+        MappedFile file(filename);
+        if (!file.isOpen()) {
+            std::cerr << "Error: Could not open file " << filename << std::endl;
+            return false;
+        }
+        auto invalid = [&filename]() {
+            std::cerr << "Error: " << filename << " is not a valid snapshot" << std::endl;
+            return false;
+        };
+        
+        SnapshotReader in(file.view());
+        SnapshotHeader header;
+        if (!in.get(header) ||
+            std::memcmp(header.magic, SnapshotHeader::expectedMagic, sizeof(header.magic)) != 0 ||
+            header.version != SnapshotHeader::currentVersion ||
+            header.keyTypes != (snapshotTypeTag<R>() | (snapshotTypeTag<C>() << 16)) ||
+            header.fileSize != file.size() || header.studentCount > UINT32_MAX) {
+            return invalid();
+        }
+        // The counts size the allocations below, so a corrupt one must be
+        // caught before anything is allocated for it: each student takes at
+        // least its 8-byte record offset and each course at least 4 bytes.
+        if (header.studentCount > file.size() / sizeof(uint64_t) ||
+            header.courseCount > file.size() / sizeof(uint32_t)) {
+            return invalid();
+        }
+        const size_t count = static_cast<size_t>(header.studentCount);
+        
+        std::vector<CourseKey<C>> courseKeys;
+        std::vector<CourseId> courseIds;
+        in.seek(header.coursesOffset);
+        for (uint64_t id = 0; id < header.courseCount && in.good(); ++id) {
+            C code{};
+            if (!in.getValue(code)) break;
+            CourseKey<C> key(code);
+            courseKeys.push_back(key);
+            courseIds.push_back(courseIdOf<C>(key));
+        }
+        
+        std::vector<uint64_t> recordOffsets(count);
+        in.seek(header.recordOffsetsOffset);
+        in.getArray(recordOffsets.data(), count);
+        
+        std::vector<Student<R, C>> loaded;
+        loaded.reserve(in.good() ? count : 0);
+        for (size_t i = 0; i < count && in.good(); ++i) {
+            std::string_view name;
+            std::string_view branch;
+            R rollNumber{};
+            int32_t startingYear = 0;
+            uint32_t currentCount = 0;
+            uint32_t previousCount = 0;
+            in.seek(recordOffsets[i]);
+            in.getString(name);
+            in.getValue(rollNumber);
+            in.getString(branch);
+            in.get(startingYear);
+            in.get(currentCount);
+            in.get(previousCount);
+            if (!in.good()) break;
             
-            if (bestChunk != -1) {
-                result.push_back(bestStudent);
-                indices[bestChunk]++;
+            loaded.emplace_back(std::string(name), rollNumber, std::string(branch), startingYear);
+            for (uint32_t c = 0; c < currentCount + previousCount; ++c) {
+                uint32_t id = 0;
+                double grade = 0.0;
+                if (!in.get(id) || !in.get(grade) || id >= courseKeys.size()) {
+                    return invalid();
+                }
+                if (c < currentCount) {
+                    loaded.back().addCurrentCourse(courseKeys[id], grade);
+                } else {
+                    loaded.back().addPreviousCourse(courseKeys[id], grade);
+                }
+            }
+        }
+        
+        auto original = std::make_shared<HandleList>(count);
+        auto sorted = std::make_shared<HandleList>(count);
+        in.seek(header.originalOrderOffset);
+        in.getArray(original->data(), count);
+        in.seek(header.sortedOrderOffset);
+        in.getArray(sorted->data(), count);
+        auto validHandle = [count](StudentHandle handle) { return handle < count; };
+        if (!std::all_of(original->begin(), original->end(), validHandle) ||
+            !std::all_of(sorted->begin(), sorted->end(), validHandle)) {
+            return invalid();
+        }
+        
+        uint64_t columnCount = 0;
+        in.seek(header.gradeIndexOffset);
+        in.get(columnCount);
+        if (columnCount > courseIds.size()) return invalid();
+        std::vector<std::pair<CourseId, std::shared_ptr<const GradeColumn::Postings>>> columns;
+        for (uint64_t column = 0; column < columnCount && in.good(); ++column) {
+            uint64_t size = 0;
+            if (!in.get(size) || size > file.size() / sizeof(GradeEntry)) return invalid();
+            GradeColumn::Entries entries(static_cast<size_t>(size));
+            in.getArray(entries.data(), entries.size());
+            for (const GradeEntry& entry : entries) {
+                if (!validHandle(entry.handle)) return invalid();
             }
+            if (!GradeColumn::inColumnOrder(entries)) return invalid();
+            columns.emplace_back(courseIds[column], GradeColumn::build(entries));
         }
+        if (!in.good() || loaded.size() != count) return invalid();
         
-        students = result;
+        auto lock = lockExclusive();
+        if (students.size() != 0) {
+            std::cerr << "Error: snapshot can only be loaded into an empty registry" << std::endl;
+            return false;
+        }
+        for (auto& student : loaded) {
+            students.emplace(std::move(student));
+        }
+        originalOrder = std::move(original);
+        originalShared.store(false, std::memory_order_relaxed);
+        sortedOrder = std::move(sorted);
+        pendingSorted.clear();
+        for (auto& column : columns) {
+            if (column.first == noCourse) continue;
+            if (column.first >= courseGradeIndex.size()) {
+                courseGradeIndex.resize(column.first + 1);
+            }
+            courseGradeIndex[column.first].assign(std::move(column.second));
+        }
+        return true;
+    }
+
+    // Sorts students on the shared ThreadPool with numThreads-way parallelism.
+    // The Comparison engine is a recursive task-parallel merge sort cut into
+    // numThreads balanced chunks; threadTimes receives each chunk's sort
+    // time. Chunk sorts and merges overlap, so phaseTimes reports the longest
+    // chunk sort as the sort phase and the rest of the wall time as the merge
+    // phase. The Radix engine is an MSD radix sort over the roll-number sort
+    // keys and has no merge phase; threadTimes holds its single entry.
+    static void parallelSort(std::vector<std::shared_ptr<Student<R, C>>>& students,
+                            int numThreads, 
+                            std::vector<std::chrono::microseconds>& threadTimes,
+                            SortPhaseTimes& phaseTimes,
+                            SortEngine engine = SortEngine::Comparison) {
+        phaseTimes = SortPhaseTimes();
+        auto startTime = std::chrono::high_resolution_clock::now();
+        if (engine == SortEngine::Radix && std::is_same_v<R, std::string>) {
+            parallelRadixSort(students,
+                              [](const std::shared_ptr<Student<R, C>>& student) {
+                                  return std::string_view(student->getSortKey());
+                              },
+                              static_cast<size_t>(std::max(numThreads, 1)));
+            auto endTime = std::chrono::high_resolution_clock::now();
+            phaseTimes.total = std::chrono::duration_cast<std::chrono::microseconds>(
+                endTime - startTime);
+            phaseTimes.sort = phaseTimes.total;
+            threadTimes.assign(1, phaseTimes.total);
+            Metrics::instance().recordSort(phaseTimes.total, phaseTimes.sort, phaseTimes.merge);
+            return;
+        }
+        
+        parallelMergeSort(students, static_cast<size_t>(std::max(numThreads, 1)),
+                          [](const std::shared_ptr<Student<R, C>>& a,
+                             const std::shared_ptr<Student<R, C>>& b) {
+                              return *a < *b;
+                          },
+                          threadTimes);
+        auto endTime = std::chrono::high_resolution_clock::now();
+        
+        phaseTimes.total = std::chrono::duration_cast<std::chrono::microseconds>(
+            endTime - startTime);
+        if (!threadTimes.empty()) {
+            phaseTimes.sort = std::min(phaseTimes.total,
+                                       *std::max_element(threadTimes.begin(), threadTimes.end()));
+        }
+        phaseTimes.merge = phaseTimes.total - phaseTimes.sort;
+        Metrics::instance().recordSort(phaseTimes.total, phaseTimes.sort, phaseTimes.merge);
+    }
+    
+    static void parallelSort(std::vector<std::shared_ptr<Student<R, C>>>& students,
+                            int numThreads, 
+                            std::vector<std::chrono::microseconds>& threadTimes) {
+        SortPhaseTimes phaseTimes;
+        parallelSort(students, numThreads, threadTimes, phaseTimes);
     }
 };
 
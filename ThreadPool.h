@@ -0,0 +1,214 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Persistent work-stealing pool. Every worker owns a deque: it pushes and
+// pops its own tasks at the back (newest first, cache-warm for recursive
+// splits) and steals from the front of other workers' deques when its own
+// is empty. Tasks submitted from outside the pool are spread round-robin.
+class ThreadPool {
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+    
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> workers;
+    std::atomic<size_t> queued{0};
+    std::atomic<size_t> nextQueue{0};
+    std::mutex sleepMutex;
+    std::condition_variable wake;
+    bool stopping = false;
+    
+    static ThreadPool*& currentPool() {
+        static thread_local ThreadPool* pool = nullptr;
+        return pool;
+    }
+    
+    static size_t& currentIndex() {
+        static thread_local size_t index = 0;
+        return index;
+    }
+    
+    bool popOwn(size_t index, std::function<void()>& task) {
+        Queue& queue = *queues[index];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.tasks.empty()) return false;
+        task = std::move(queue.tasks.back());
+        queue.tasks.pop_back();
+        return true;
+    }
+    
+    bool steal(size_t start, std::function<void()>& task) {
+        for (size_t i = 0; i < queues.size(); ++i) {
+            Queue& queue = *queues[(start + i) % queues.size()];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            if (!queue.tasks.empty()) {
+                task = std::move(queue.tasks.front());
+                queue.tasks.pop_front();
+                return true;
+            }
+        }
+        return false;
+    }
+    
+    bool takeTask(std::function<void()>& task) {
+        if (currentPool() == this && popOwn(currentIndex(), task)) {
+            queued--;
+            return true;
+        }
+        size_t start = currentPool() == this ? currentIndex() + 1 : nextQueue.load();
+        if (steal(start, task)) {
+            queued--;
+            return true;
+        }
+        return false;
+    }
+    
+    void workerLoop(size_t index) {
+        currentPool() = this;
+        currentIndex() = index;
+        std::function<void()> task;
+        while (true) {
+            if (takeTask(task)) {
+                task();
+                task = nullptr;
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(sleepMutex);
+            wake.wait(lock, [this] { return stopping || queued.load() > 0; });
+            if (stopping && queued.load() == 0) return;
+        }
+    }
+    
+public:
+    explicit ThreadPool(size_t threadCount = std::thread::hardware_concurrency()) {
+        threadCount = std::max<size_t>(1, threadCount);
+        for (size_t i = 0; i < threadCount; ++i) {
+            queues.push_back(std::make_unique<Queue>());
+        }
+        for (size_t i = 0; i < threadCount; ++i) {
+            workers.emplace_back(&ThreadPool::workerLoop, this, i);
+        }
+    }
+    
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+    
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+    
+    // Shared pool sized to the hardware concurrency.
+    static ThreadPool& instance() {
+        static ThreadPool pool;
+        return pool;
+    }
+    
+    size_t size() const { return workers.size(); }
+    
+    void submit(std::function<void()> task) {
+        size_t index = currentPool() == this ? currentIndex()
+                                             : nextQueue.fetch_add(1) % queues.size();
+        {
+            std::lock_guard<std::mutex> lock(queues[index]->mutex);
+            queues[index]->tasks.push_back(std::move(task));
+        }
+        queued++;
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+        }
+        wake.notify_one();
+    }
+    
+    // Runs one queued task on the calling thread, if there is one. Lets a
+    // thread that waits on other tasks help instead of blocking.
+    bool runPendingTask() {
+        std::function<void()> task;
+        if (!takeTask(task)) return false;
+        task();
+        return true;
+    }
+};
+
+// A set of tasks submitted to a pool that can be waited on together. wait()
+// runs queued tasks while there are any, so groups can nest inside pool
+// tasks without tying up workers, and then sleeps until the group's tasks
+// still running on other threads finish. The first exception thrown by a
+// task is rethrown from wait().
+class TaskGroup {
+private:
+    ThreadPool& pool;
+    std::atomic<size_t> pending{0};
+    std::mutex errorMutex;
+    std::exception_ptr error;
+    // The last task decrements pending under doneMutex, so a waiter that
+    // sees zero under it knows no task still touches the group.
+    std::mutex doneMutex;
+    std::condition_variable done;
+    
+public:
+    explicit TaskGroup(ThreadPool& pool = ThreadPool::instance()) : pool(pool) {}
+    
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+    
+    ~TaskGroup() {
+        try {
+            wait();
+        } catch (...) {
+        }
+    }
+    
+    template<typename Fn>
+    void run(Fn&& fn) {
+        pending++;
+        pool.submit([this, fn = std::forward<Fn>(fn)]() mutable {
+            try {
+                fn();
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(errorMutex);
+                if (!error) error = std::current_exception();
+            }
+            std::lock_guard<std::mutex> lock(doneMutex);
+            if (--pending == 0) done.notify_all();
+        });
+    }
+    
+    void wait() {
+        // Once nothing is left to help with, the group's remaining tasks are
+        // running on other threads.
+        while (pending.load() > 0 && pool.runPendingTask()) {
+        }
+        {
+            std::unique_lock<std::mutex> lock(doneMutex);
+            done.wait(lock, [this] { return pending.load() == 0; });
+        }
+        std::exception_ptr failure;
+        {
+            std::lock_guard<std::mutex> lock(errorMutex);
+            std::swap(failure, error);
+        }
+        if (failure) std::rethrow_exception(failure);
+    }
+};
+
+#endif
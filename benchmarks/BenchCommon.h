@@ -0,0 +1,129 @@
+#ifndef BENCH_COMMON_H
+#define BENCH_COMMON_H
+
+#include "../Student.h"
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace bench {
+
+using Clock = std::chrono::steady_clock;
+
+inline double secondsSince(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+template<typename Fn>
+double timeSeconds(Fn&& fn) {
+    auto start = Clock::now();
+    fn();
+    return secondsSince(start);
+}
+
+inline size_t sizeArg(int argc, char** argv, int index, size_t fallback) {
+    if (argc > index) {
+        return static_cast<size_t>(std::strtoull(argv[index], nullptr, 10));
+    }
+    return fallback;
+}
+
+inline const std::vector<std::string>& courseCodes() {
+    static const std::vector<std::string> codes = {
+        "OOPD", "DSA", "AI", "ML", "DBMS", "CN", "OS", "101", "202", "303", "404", "505"
+    };
+    return codes;
+}
+
+// Roll numbers follow the shapes seen in students.csv: "2020CS1000",
+// plain numeric "12123", and longer numeric "334455".
+inline std::string makeRollNumber(std::mt19937_64& rng) {
+    static const char* branches[] = {"CS", "EC", "EE", "IT", "ME"};
+    switch (rng() % 3) {
+        case 0:
+            return std::to_string(2018 + rng() % 7) + branches[rng() % 5] +
+                   std::to_string(1000 + rng() % 9000);
+        case 1:
+            return std::to_string(10000 + rng() % 90000);
+        default:
+            return std::to_string(100000 + rng() % 900000);
+    }
+}
+
+inline double makeGrade(std::mt19937_64& rng) {
+    return static_cast<double>(40 + rng() % 61) / 10.0;
+}
+
+inline std::vector<std::shared_ptr<Student<std::string, std::string>>>
+makeStudents(size_t count, unsigned seed = 42) {
+    std::mt19937_64 rng(seed);
+    const auto& codes = courseCodes();
+    std::vector<std::shared_ptr<Student<std::string, std::string>>> students;
+    students.reserve(count);
+    
+    for (size_t i = 0; i < count; ++i) {
+        auto student = std::make_shared<Student<std::string, std::string>>(
+            "Student" + std::to_string(i), makeRollNumber(rng), "CSE",
+            static_cast<int>(2018 + rng() % 7));
+        for (int c = 0; c < 3; ++c) {
+            student->addCurrentCourse(codes[rng() % codes.size()], 0.0);
+        }
+        for (int c = 0; c < 3; ++c) {
+            student->addPreviousCourse(codes[rng() % codes.size()], makeGrade(rng));
+        }
+        students.push_back(student);
+    }
+    return students;
+}
+
+// The IIT-D style integer course codes among courseCodes().
+inline const std::vector<std::string>& numericCourseCodes() {
+    static const std::vector<std::string> codes = {"101", "202", "303", "404", "505"};
+    return codes;
+}
+
+// Writes a students.csv-style file with the two-column course format. With
+// numericCourses every course code is an integer, so the file also parses
+// as Student<R, int> without rejected entries.
+inline void writeStudentsCsv(const std::string& path, size_t count, unsigned seed = 42,
+                             bool numericCourses = false) {
+    std::mt19937_64 rng(seed);
+    const auto& codes = numericCourses ? numericCourseCodes() : courseCodes();
+    std::ofstream out(path);
+    out << "Name,RollNumber,Branch,StartingYear,CurrentCourses,PreviousCourses\n";
+    
+    for (size_t i = 0; i < count; ++i) {
+        out << "Student " << i << ',' << makeRollNumber(rng) << ",CSE,"
+            << 2018 + rng() % 7 << ',';
+        for (int c = 0; c < 3; ++c) {
+            out << (c ? ";" : "") << codes[rng() % codes.size()] << ':' << makeGrade(rng);
+        }
+        out << ',';
+        for (int c = 0; c < 3; ++c) {
+            out << (c ? ";" : "") << codes[rng() % codes.size()] << ':' << makeGrade(rng);
+        }
+        out << '\n';
+    }
+}
+
+inline double fileMegabytes(const std::string& path) {
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    return static_cast<double>(in.tellg()) / (1024.0 * 1024.0);
+}
+
+inline void report(const std::string& name, size_t n, double seconds) {
+    std::cout << std::left << std::setw(40) << name
+              << " n=" << std::setw(9) << n
+              << std::right << std::fixed << std::setprecision(3)
+              << std::setw(12) << seconds * 1000.0 << " ms" << std::endl;
+}
+
+}
+
+#endif
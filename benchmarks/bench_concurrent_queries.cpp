@@ -0,0 +1,111 @@
+#include "BenchCommon.h"
+#include "../StudentRegistry.h"
+#include <atomic>
+#include <thread>
+
+using Registry = StudentRegistry<std::string, std::string>;
+
+namespace {
+
+// Runs one reader's query loop and checks every snapshot it sees: the sorted
+// view must be in order, grade ranges must be descending and above the
+// threshold, and the registry must never shrink.
+void readerLoop(const Registry& registry, unsigned seed, const std::atomic<bool>& stop,
+                std::atomic<size_t>& queries, std::atomic<size_t>& violations) {
+    std::mt19937_64 rng(seed);
+    const auto& codes = bench::courseCodes();
+    size_t done = 0;
+    size_t lastSize = 0;
+    while (!stop.load(std::memory_order_relaxed)) {
+        const std::string& code = codes[rng() % codes.size()];
+        double minGrade = 8.0 + (rng() % 21) / 10.0;
+        
+        auto range = registry.gradeRange(code, minGrade);
+        double previous = 11.0;
+        for (auto it = range.begin(); it != range.end(); ++it) {
+            if (it.grade() < minGrade || it.grade() > previous) violations++;
+            previous = it.grade();
+        }
+        
+        if (done % 64 == 0) {
+            auto view = registry.sortedView();
+            const Student<std::string, std::string>* last = nullptr;
+            for (const auto* student : view) {
+                if (last && *student < *last) violations++;
+                last = student;
+            }
+            if (view.size() < lastSize) violations++;
+            lastSize = view.size();
+        }
+        done++;
+    }
+    queries += done;
+}
+
+struct RunResult {
+    double qps;
+    size_t added;
+    size_t violations;
+};
+
+RunResult run(const Registry& registry, Registry* writable, int readers, double seconds,
+              const std::vector<std::shared_ptr<Student<std::string, std::string>>>& extra) {
+    std::atomic<bool> stop{false};
+    std::atomic<size_t> queries{0};
+    std::atomic<size_t> violations{0};
+    size_t added = 0;
+    
+    std::vector<std::thread> threads;
+    for (int i = 0; i < readers; ++i) {
+        threads.emplace_back(readerLoop, std::cref(registry), 100 + i, std::cref(stop),
+                             std::ref(queries), std::ref(violations));
+    }
+    
+    auto start = bench::Clock::now();
+    if (writable) {
+        const size_t batch = 256;
+        while (bench::secondsSince(start) < seconds && added < extra.size()) {
+            size_t end = std::min(extra.size(), added + batch);
+            writable->addStudents(extra.begin() + added, extra.begin() + end);
+            added = end;
+        }
+    }
+    while (bench::secondsSince(start) < seconds) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    stop = true;
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    return {queries / bench::secondsSince(start), added, violations.load()};
+}
+
+}
+
+int main(int argc, char** argv) {
+    size_t count = bench::sizeArg(argc, argv, 1, 100000);
+    size_t maxReaders = bench::sizeArg(argc, argv, 2, 8);
+    double seconds = bench::sizeArg(argc, argv, 3, 1000) / 1000.0;
+    
+    auto extra = bench::makeStudents(count, 7);
+    size_t failures = 0;
+    
+    std::cout << "students=" << count << " interval=" << seconds << "s"
+              << " hardware threads=" << std::thread::hardware_concurrency() << "\n"
+              << std::fixed << std::setprecision(0);
+    for (size_t readers = 1; readers <= maxReaders; readers *= 2) {
+        Registry registry;
+        registry.addStudents(bench::makeStudents(count));
+        RunResult idle = run(registry, nullptr, static_cast<int>(readers), seconds, extra);
+        RunResult busy = run(registry, &registry, static_cast<int>(readers), seconds, extra);
+        failures += idle.violations + busy.violations;
+        if (registry.size() != count + busy.added) failures++;
+        
+        std::cout << "readers=" << readers
+                  << "  read-only: " << idle.qps << " queries/s"
+                  << "  with writer: " << busy.qps << " queries/s"
+                  << " (" << busy.added << " students added)\n";
+    }
+    std::cout << "invariant violations: " << failures << std::endl;
+    return failures == 0 ? 0 : 1;
+}
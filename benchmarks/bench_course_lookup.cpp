@@ -0,0 +1,63 @@
+#include "BenchCommon.h"
+
+using StudentSS = Student<std::string, std::string>;
+
+int main(int argc, char** argv) {
+    size_t count = bench::sizeArg(argc, argv, 1, 200000);
+    size_t rounds = bench::sizeArg(argc, argv, 2, 5);
+    
+    std::mt19937_64 rng(11);
+    const auto& codes = bench::courseCodes();
+    std::vector<StudentSS> students;
+    students.reserve(count);
+    for (const auto& student : bench::makeStudents(count)) {
+        students.push_back(*student);
+    }
+    
+    std::vector<std::string> lookups;
+    for (size_t i = 0; i < count; ++i) {
+        lookups.push_back(codes[rng() % codes.size()]);
+    }
+    
+    std::vector<InternedCourse> internedLookups(lookups.begin(), lookups.end());
+    
+    double sum = 0.0;
+    double gradeSeconds = bench::timeSeconds([&] {
+        for (size_t r = 0; r < rounds; ++r) {
+            for (size_t i = 0; i < count; ++i) {
+                sum += students[i].getGrade(lookups[i]);
+            }
+        }
+    });
+    
+    double internedSeconds = bench::timeSeconds([&] {
+        for (size_t r = 0; r < rounds; ++r) {
+            for (size_t i = 0; i < count; ++i) {
+                sum += students[i].getGrade(internedLookups[i]);
+            }
+        }
+    });
+    
+    size_t completed = 0;
+    double completeSeconds = 0.0;
+    for (size_t r = 0; r < rounds; ++r) {
+        std::vector<StudentSS> working = students;
+        completeSeconds += bench::timeSeconds([&] {
+            for (auto& student : working) {
+                while (!student.getCurrentCourses().empty()) {
+                    student.completeCourse(student.getCurrentCourses().begin()->first);
+                    completed++;
+                }
+            }
+        });
+    }
+    
+    std::cout << "sizeof(Student<string, string>): " << sizeof(StudentSS) << " bytes\n"
+              << std::fixed << std::setprecision(1)
+              << "getGrade:       " << count * rounds / gradeSeconds / 1e6 << " M lookups/s\n"
+              << "getGrade(InternedCourse): " << count * rounds / internedSeconds / 1e6
+              << " M lookups/s\n"
+              << "completeCourse: " << completed / completeSeconds / 1e6 << " M calls/s\n"
+              << "(checksum " << sum << ")" << std::endl;
+    return 0;
+}
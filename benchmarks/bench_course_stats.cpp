@@ -0,0 +1,116 @@
+#include "BenchCommon.h"
+#include "../StudentRegistry.h"
+#include <cmath>
+#include <limits>
+
+using Registry = StudentRegistry<std::string, std::string>;
+
+namespace {
+
+// A course's grades read off the students themselves rather than the grade
+// index, so a bad bucket, posting or flush shows up as a mismatch: each
+// student's higher of previous and current grade, on-scale grades rounded
+// to tenths as the index stores them. Sorted ascending.
+std::vector<double> courseGrades(const Registry& registry, const std::string& course) {
+    CourseKey<std::string> key(course);
+    std::vector<double> grades;
+    for (const auto* student : registry.originalView()) {
+        const auto& previous = student->getPreviousCourses();
+        const auto& current = student->getCurrentCourses();
+        auto previousIt = previous.find(key);
+        auto currentIt = current.find(key);
+        double grade = std::numeric_limits<double>::quiet_NaN();
+        if (previousIt != previous.end()) grade = previousIt->second;
+        if (currentIt != current.end() &&
+            (previousIt == previous.end() || currentIt->second > grade)) {
+            grade = currentIt->second;
+        }
+        if (std::isnan(grade)) continue;
+        if (auto tenths = GradeScale::toTenths(grade)) grade = GradeScale::toGrade(*tenths);
+        grades.push_back(grade);
+    }
+    std::sort(grades.begin(), grades.end());
+    return grades;
+}
+
+// Stats the way callers derived them before the cache: walk every student,
+// sort the course's grades, and pick nearest ranks.
+CourseStats bruteForceStats(const Registry& registry, const std::string& course) {
+    std::vector<double> grades = courseGrades(registry, course);
+    CourseStats stats;
+    if (grades.empty()) return stats;
+    size_t n = grades.size();
+    auto rank = [n](double percent) {
+        size_t r = static_cast<size_t>(std::ceil(percent * static_cast<double>(n) / 100.0));
+        return std::clamp<size_t>(r, 1, n) - 1;
+    };
+    double sum = 0.0;
+    for (double grade : grades) {
+        sum += grade;
+    }
+    stats.count = n;
+    stats.mean = sum / static_cast<double>(n);
+    stats.min = grades[rank(0.0)];
+    stats.median = grades[rank(50.0)];
+    stats.topDecileCutoff = grades[rank(90.0)];
+    stats.max = grades[rank(100.0)];
+    return stats;
+}
+
+bool sameStats(const CourseStats& a, const CourseStats& b) {
+    return a.count == b.count && std::fabs(a.mean - b.mean) <= 1e-9 * std::fabs(b.mean) &&
+           a.min == b.min && a.median == b.median && a.topDecileCutoff == b.topDecileCutoff &&
+           a.max == b.max;
+}
+
+}
+
+int main(int argc, char** argv) {
+    size_t count = bench::sizeArg(argc, argv, 1, 500000);
+    size_t batches = bench::sizeArg(argc, argv, 2, 10);
+    size_t rounds = bench::sizeArg(argc, argv, 3, 1000);
+    const auto& codes = bench::courseCodes();
+
+    // Stats must agree with brute force after every incremental batch.
+    Registry registry;
+    auto input = bench::makeStudents(count);
+    size_t mismatches = 0;
+    for (size_t b = 0; b < batches; ++b) {
+        registry.addStudents(input.begin() + count * b / batches,
+                             input.begin() + count * (b + 1) / batches);
+        for (const auto& code : codes) {
+            if (!sameStats(registry.courseStats(code), bruteForceStats(registry, code))) {
+                mismatches++;
+            }
+        }
+    }
+    std::vector<double> grades = courseGrades(registry, codes[0]);
+    for (double percent = 0.0; percent <= 100.0; percent += 2.5) {
+        size_t rank = static_cast<size_t>(std::ceil(percent * grades.size() / 100.0));
+        if (registry.gradePercentile(codes[0], percent) !=
+            grades[std::clamp<size_t>(rank, 1, grades.size()) - 1]) {
+            mismatches++;
+        }
+    }
+
+    double checksum = 0.0;
+    double cachedSeconds = bench::timeSeconds([&] {
+        for (size_t r = 0; r < rounds; ++r) {
+            checksum += registry.courseStats(codes[r % codes.size()]).median;
+        }
+    });
+    size_t bruteRounds = std::max<size_t>(1, rounds / 100);
+    double bruteSeconds = bench::timeSeconds([&] {
+        for (size_t r = 0; r < bruteRounds; ++r) {
+            checksum += bruteForceStats(registry, codes[r % codes.size()]).median;
+        }
+    });
+
+    std::cout << "students=" << count << " batches=" << batches << " courses=" << codes.size()
+              << "\n" << std::fixed << std::setprecision(3)
+              << "courseStats:  " << cachedSeconds * 1e6 / rounds << " us/query\n"
+              << "brute force:  " << bruteSeconds * 1e6 / bruteRounds << " us/query\n"
+              << "mismatches against brute force: " << mismatches
+              << " (checksum " << checksum << ")" << std::endl;
+    return mismatches == 0 ? 0 : 1;
+}
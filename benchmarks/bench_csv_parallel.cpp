@@ -0,0 +1,41 @@
+#include "BenchCommon.h"
+#include "../CSVReader.h"
+
+int main(int argc, char** argv) {
+    size_t rows = bench::sizeArg(argc, argv, 1, 500000);
+    int maxThreads = static_cast<int>(bench::sizeArg(argc, argv, 2, 16));
+    std::string path = "/tmp/erp_bench_students_parallel.csv";
+    bench::writeStudentsCsv(path, rows);
+    double megabytes = bench::fileMegabytes(path);
+    std::cout << "input: " << rows << " rows, " << std::fixed << std::setprecision(1)
+              << megabytes << " MB, hardware threads: "
+              << std::thread::hardware_concurrency() << std::endl;
+    
+    auto reference = CSVReader::readStudentsMapped(path);
+    double baseline = 0.0;
+    int status = 0;
+    
+    for (int threads = 1; threads <= maxThreads; threads *= 2) {
+        std::vector<std::shared_ptr<Student<std::string, std::string>>> students;
+        double seconds = bench::timeSeconds([&] {
+            students = CSVReader::readStudentsParallel(path, threads);
+        });
+        if (threads == 1) baseline = seconds;
+        
+        bool sameOrder = students.size() == reference.size();
+        for (size_t i = 0; sameOrder && i < students.size(); ++i) {
+            sameOrder = students[i]->getRollNumber() == reference[i]->getRollNumber() &&
+                        students[i]->getName() == reference[i]->getName();
+        }
+        if (!sameOrder) status = 1;
+        
+        std::cout << "threads=" << std::setw(2) << threads
+                  << std::setw(10) << std::setprecision(1) << seconds * 1000.0 << " ms"
+                  << std::setw(9) << megabytes / seconds << " MB/s"
+                  << "  speedup " << std::setprecision(2) << baseline / seconds << "x"
+                  << (sameOrder ? "" : "  ORDER MISMATCH") << std::endl;
+    }
+    
+    std::remove(path.c_str());
+    return status;
+}
@@ -0,0 +1,34 @@
+#include "BenchCommon.h"
+#include "../CSVReader.h"
+
+template<typename R, typename C>
+static size_t runRead(const std::string& name, const std::string& path, double megabytes) {
+    CSVReadStats stats;
+    size_t rows = 0;
+    double seconds = bench::timeSeconds([&] {
+        rows = CSVReader::read<R, C>(path, 1, &stats).size();
+    });
+    std::cout << std::left << std::setw(28) << name << " rows=" << std::setw(9) << rows
+              << "rejected=" << std::setw(8) << stats.rowsRejected
+              << "bad entries=" << std::setw(9) << stats.entriesRejected
+              << std::right << std::fixed << std::setprecision(1)
+              << std::setw(10) << seconds * 1000.0 << " ms"
+              << std::setw(10) << megabytes / seconds << " MB/s" << std::endl;
+    return rows;
+}
+
+int main(int argc, char** argv) {
+    size_t rows = bench::sizeArg(argc, argv, 1, 500000);
+    std::string path = "/tmp/erp_bench_students.csv";
+    bench::writeStudentsCsv(path, rows);
+    double megabytes = bench::fileMegabytes(path);
+    std::cout << "input: " << path << " (" << std::fixed << std::setprecision(1)
+              << megabytes << " MB)" << std::endl;
+    
+    size_t parsed = runRead<std::string, std::string>("read<string, string>", path, megabytes);
+    runRead<std::string, int>("read<string, int>", path, megabytes);
+    runRead<unsigned, int>("read<unsigned, int>", path, megabytes);
+    
+    std::remove(path.c_str());
+    return parsed == rows ? 0 : 1;
+}
@@ -0,0 +1,92 @@
+#include "BenchCommon.h"
+#include "../CSVReader.h"
+#include "../StudentRegistry.h"
+#include <fstream>
+
+using Registry = StudentRegistry<std::string, std::string>;
+
+namespace {
+
+// Peak resident set size since the last resetPeakMemory(), in MB.
+double peakMegabytes() {
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.compare(0, 6, "VmHWM:") == 0) {
+            return std::strtod(line.c_str() + 6, nullptr) / 1024.0;
+        }
+    }
+    return 0.0;
+}
+
+void resetPeakMemory() {
+    std::ofstream("/proc/self/clear_refs") << "5";
+}
+
+void reportRun(const std::string& name, double seconds, double baseline, size_t count) {
+    std::cout << std::left << std::setw(34) << name << std::right << std::fixed
+              << std::setprecision(1) << std::setw(9) << seconds * 1000.0 << " ms"
+              << "  peak +" << std::setw(7) << peakMegabytes() - baseline << " MB"
+              << "  students=" << count << std::endl;
+}
+
+}
+
+int main(int argc, char** argv) {
+    size_t rows = bench::sizeArg(argc, argv, 1, 1000000);
+    size_t batchSize = bench::sizeArg(argc, argv, 2, 4096);
+    std::string path = "/tmp/erp_bench_stream.csv";
+    bench::writeStudentsCsv(path, rows);
+    std::cout << "input: " << rows << " rows, " << std::fixed << std::setprecision(1)
+              << bench::fileMegabytes(path) << " MB, batch=" << batchSize << std::endl;
+    
+    // The filter pipeline runs first so that its peak is not hidden behind
+    // memory the allocator kept from the other runs.
+    resetPeakMemory();
+    double baseline = peakMegabytes();
+    size_t streamedHits = 0;
+    double filterSeconds = bench::timeSeconds([&] {
+        CSVReader::readBatches<std::string, std::string>(path, batchSize, [&](auto& batch) {
+            for (const auto& student : batch) {
+                streamedHits += student->getGrade(std::string("DSA")) >= 9.0;
+            }
+        });
+    });
+    reportRun("streaming filter (DSA >= 9.0)", filterSeconds, baseline, streamedHits);
+    
+    size_t streamedCount = 0;
+    {
+        resetPeakMemory();
+        baseline = peakMegabytes();
+        Registry registry;
+        double seconds = bench::timeSeconds([&] {
+            CSVReader::readBatches<std::string, std::string>(path, batchSize, [&](auto& batch) {
+                registry.addStudents(batch);
+            });
+            registry.sortedBegin();
+        });
+        streamedCount = registry.size();
+        reportRun("readBatches -> registry", seconds, baseline, streamedCount);
+    }
+    
+    size_t fullHits = 0;
+    size_t fullCount = 0;
+    {
+        resetPeakMemory();
+        baseline = peakMegabytes();
+        Registry registry;
+        double seconds = bench::timeSeconds([&] {
+            auto students = CSVReader::read<std::string, std::string>(path);
+            for (const auto& student : students) {
+                fullHits += student->getGrade(std::string("DSA")) >= 9.0;
+            }
+            registry.addStudents(students);
+            registry.sortedBegin();
+        });
+        fullCount = registry.size();
+        reportRun("read() vector -> registry", seconds, baseline, fullCount);
+    }
+    
+    std::remove(path.c_str());
+    return streamedHits == fullHits && streamedCount == fullCount ? 0 : 1;
+}
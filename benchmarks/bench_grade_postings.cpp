@@ -0,0 +1,161 @@
+#include "BenchCommon.h"
+#include "../GradeColumn.h"
+#include <cmath>
+
+namespace {
+
+// The flat per-course column the grade index used before bitmap buckets:
+// one 16-byte (grade, handle) entry per posting, highest grade first.
+struct FlatColumn {
+    std::vector<GradeEntry> entries;
+
+    size_t countAtLeast(double minGrade) const {
+        return static_cast<size_t>(
+            std::partition_point(entries.begin(), entries.end(),
+                                 [minGrade](const GradeEntry& e) { return e.grade >= minGrade; }) -
+            entries.begin());
+    }
+
+    std::vector<uint64_t> bitmapAtLeast(double minGrade, size_t students) const {
+        std::vector<uint64_t> bits((students + 63) / 64, 0);
+        for (size_t e = 0, n = countAtLeast(minGrade); e < n; ++e) {
+            bits[entries[e].handle / 64] |= uint64_t(1) << (entries[e].handle % 64);
+        }
+        return bits;
+    }
+};
+
+std::vector<StudentHandle> handlesOf(const std::vector<uint64_t>& bits) {
+    std::vector<StudentHandle> handles;
+    for (size_t w = 0; w < bits.size(); ++w) {
+        for (uint64_t word = bits[w]; word != 0; word &= word - 1) {
+            handles.push_back(static_cast<StudentHandle>(w * 64 + __builtin_ctzll(word)));
+        }
+    }
+    return handles;
+}
+
+}
+
+int main(int argc, char** argv) {
+    size_t students = bench::sizeArg(argc, argv, 1, 1000000);
+    size_t courses = bench::sizeArg(argc, argv, 2, 8);
+    size_t queries = bench::sizeArg(argc, argv, 3, 200);
+
+    std::mt19937_64 rng(3);
+    std::vector<FlatColumn> flat(courses);
+    std::vector<GradeColumn> bucketed(courses);
+    for (size_t c = 0; c < courses; ++c) {
+        for (size_t s = 0; s < students; ++s) {
+            double grade = bench::makeGrade(rng);
+            flat[c].entries.push_back(GradeEntry{grade, static_cast<StudentHandle>(s)});
+            bucketed[c].add(grade, static_cast<StudentHandle>(s));
+        }
+        std::sort(flat[c].entries.begin(), flat[c].entries.end(),
+                  [](const GradeEntry& a, const GradeEntry& b) {
+                      return a.grade != b.grade ? a.grade > b.grade : a.handle < b.handle;
+                  });
+        flat[c].entries.shrink_to_fit();
+        bucketed[c].flush();
+    }
+
+    size_t flatBytes = 0;
+    size_t bucketedBytes = 0;
+    for (size_t c = 0; c < courses; ++c) {
+        flatBytes += flat[c].entries.capacity() * sizeof(GradeEntry);
+        bucketedBytes += bucketed[c].snapshot()->memoryUsage();
+    }
+    double postings = static_cast<double>(students * courses);
+    std::cout << "students=" << students << " courses=" << courses << " queries=" << queries
+              << "\n" << std::fixed << std::setprecision(2)
+              << "index memory  flat " << flatBytes / 1048576.0 << " MB ("
+              << flatBytes / postings << " B/posting)  bitmap buckets "
+              << bucketedBytes / 1048576.0 << " MB (" << bucketedBytes / postings
+              << " B/posting)" << std::endl;
+
+    // Fixed-point buckets must answer every threshold exactly like the
+    // double grades, including thresholds between and just around steps.
+    size_t thresholdMismatches = 0;
+    for (int step = -20; step <= 120; ++step) {
+        double grid = step / 10.0;
+        for (double minGrade : {grid, grid + 0.05, std::nextafter(grid, -1e9),
+                                std::nextafter(grid, 1e9)}) {
+            if (flat[0].countAtLeast(minGrade) != bucketed[0].snapshot()->countAtLeast(minGrade)) {
+                thresholdMismatches++;
+            }
+        }
+    }
+    if (thresholdMismatches != 0) {
+        std::cout << "THRESHOLD MISMATCHES: " << thresholdMismatches << std::endl;
+        return 1;
+    }
+
+    std::vector<std::pair<size_t, double>> workload;
+    for (size_t q = 0; q < queries; ++q) {
+        workload.emplace_back(rng() % courses, 8.0 + (rng() % 21) / 10.0);
+    }
+
+    int status = 0;
+    size_t flatSum = 0;
+    size_t bucketedSum = 0;
+    double flatIterate = bench::timeSeconds([&] {
+        for (const auto& query : workload) {
+            const FlatColumn& column = flat[query.first];
+            for (size_t e = 0, n = column.countAtLeast(query.second); e < n; ++e) {
+                flatSum += column.entries[e].handle;
+            }
+        }
+    });
+    double bucketedIterate = bench::timeSeconds([&] {
+        for (const auto& query : workload) {
+            const auto& postingsOf = *bucketed[query.first].snapshot();
+            for (size_t b = 0, n = postingsOf.bucketsAtLeast(query.second); b < n; ++b) {
+                for (StudentHandle handle : *postingsOf.buckets[b].students) {
+                    bucketedSum += handle;
+                }
+            }
+        }
+    });
+    if (flatSum != bucketedSum) status = 1;
+    std::cout << std::setprecision(3) << "range scan    flat "
+              << flatIterate * 1000.0 / queries << " ms/query  bitmap buckets "
+              << bucketedIterate * 1000.0 / queries << " ms/query"
+              << (flatSum == bucketedSum ? "" : "  MISMATCH") << std::endl;
+
+    for (bool all : {true, false}) {
+        std::vector<std::vector<StudentHandle>> expected;
+        double flatSeconds = bench::timeSeconds([&] {
+            for (const auto& query : workload) {
+                size_t other = (query.first + 1) % courses;
+                auto result = flat[query.first].bitmapAtLeast(query.second, students);
+                auto second = flat[other].bitmapAtLeast(query.second, students);
+                for (size_t w = 0; w < result.size(); ++w) {
+                    result[w] = all ? result[w] & second[w] : result[w] | second[w];
+                }
+                expected.push_back(handlesOf(result));
+            }
+        });
+        bool same = true;
+        size_t index = 0;
+        double bucketedSeconds = bench::timeSeconds([&] {
+            for (const auto& query : workload) {
+                size_t other = (query.first + 1) % courses;
+                RoaringBitmap result = bucketed[query.first].snapshot()->studentsAtLeast(
+                    query.second);
+                RoaringBitmap second = bucketed[other].snapshot()->studentsAtLeast(query.second);
+                if (all) {
+                    result &= second;
+                } else {
+                    result = RoaringBitmap::unionOf({&result, &second});
+                }
+                same = same && result.toVector() == expected[index++];
+            }
+        });
+        if (!same) status = 1;
+        std::cout << (all ? "2-course AND" : "2-course OR ") << "  flat "
+                  << flatSeconds * 1000.0 / queries << " ms/query  bitmap buckets "
+                  << bucketedSeconds * 1000.0 / queries << " ms/query"
+                  << (same ? "" : "  MISMATCH") << std::endl;
+    }
+    return status;
+}
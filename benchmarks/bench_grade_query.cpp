@@ -0,0 +1,55 @@
+#include "BenchCommon.h"
+#include "../StudentRegistry.h"
+
+using Registry = StudentRegistry<std::string, std::string>;
+
+int main(int argc, char** argv) {
+    size_t count = bench::sizeArg(argc, argv, 1, 200000);
+    size_t queries = bench::sizeArg(argc, argv, 2, 2000);
+    
+    Registry registry;
+    registry.addStudents(bench::makeStudents(count));
+    
+    std::mt19937_64 rng(5);
+    const auto& codes = bench::courseCodes();
+    std::vector<std::pair<std::string, double>> workload;
+    for (size_t i = 0; i < queries; ++i) {
+        workload.emplace_back(codes[rng() % codes.size()], 8.0 + (rng() % 21) / 10.0);
+    }
+    for (const auto& code : codes) {
+        registry.gradeRange(code, 0.0);
+    }
+    
+    size_t countOnlyHits = 0;
+    double countSeconds = bench::timeSeconds([&] {
+        for (const auto& query : workload) {
+            countOnlyHits += registry.gradeRange(query.first, query.second).size();
+        }
+    });
+    
+    size_t rangeHits = 0;
+    double rangeSeconds = bench::timeSeconds([&] {
+        for (const auto& query : workload) {
+            auto range = registry.gradeRange(query.first, query.second);
+            for (auto it = range.begin(); it != range.end(); ++it) {
+                rangeHits += it.grade() >= query.second;
+            }
+        }
+    });
+    
+    size_t vectorHits = 0;
+    double vectorSeconds = bench::timeSeconds([&] {
+        for (const auto& query : workload) {
+            vectorHits += registry.getStudentsWithGrade(query.first, query.second).size();
+        }
+    });
+    
+    std::cout << "students=" << count << " queries=" << queries
+              << " avg hits/query=" << rangeHits / queries << "\n"
+              << std::fixed << std::setprecision(0)
+              << "gradeRange (span, size only):    " << queries / countSeconds << " queries/s\n"
+              << "gradeRange (span, iterated):     " << queries / rangeSeconds << " queries/s\n"
+              << "getStudentsWithGrade (vector):   " << queries / vectorSeconds << " queries/s"
+              << std::endl;
+    return rangeHits == vectorHits && countOnlyHits == vectorHits ? 0 : 1;
+}
@@ -0,0 +1,93 @@
+#include "BenchCommon.h"
+#include "../StudentRegistry.h"
+
+using Registry = StudentRegistry<std::string, std::string>;
+
+namespace {
+
+// The same query composed from single-course gradeRange calls: collect each
+// course's handles, sort them, and intersect or unite the lists.
+std::vector<StudentHandle> composeRanges(const Registry& registry,
+                                         const std::vector<Registry::GradeCondition>& conditions,
+                                         GradeMatch match) {
+    std::vector<StudentHandle> result;
+    for (size_t i = 0; i < conditions.size(); ++i) {
+        auto range = registry.gradeRange(conditions[i].course, conditions[i].minGrade);
+        std::vector<StudentHandle> handles;
+        for (auto it = range.begin(); it != range.end(); ++it) {
+            handles.push_back(it.handle());
+        }
+        std::sort(handles.begin(), handles.end());
+        if (i == 0) {
+            result = std::move(handles);
+            continue;
+        }
+        std::vector<StudentHandle> combined;
+        if (match == GradeMatch::All) {
+            std::set_intersection(result.begin(), result.end(), handles.begin(), handles.end(),
+                                  std::back_inserter(combined));
+        } else {
+            std::set_union(result.begin(), result.end(), handles.begin(), handles.end(),
+                           std::back_inserter(combined));
+        }
+        result = std::move(combined);
+    }
+    return result;
+}
+
+}
+
+int main(int argc, char** argv) {
+    size_t count = bench::sizeArg(argc, argv, 1, 1000000);
+    size_t queries = bench::sizeArg(argc, argv, 2, 200);
+    
+    Registry registry;
+    registry.addStudents(bench::makeStudents(count));
+    const auto& codes = bench::courseCodes();
+    for (const auto& code : codes) {
+        registry.gradeRange(code, 0.0);
+    }
+    
+    std::mt19937_64 rng(11);
+    std::vector<std::vector<Registry::GradeCondition>> workload(queries);
+    for (auto& conditions : workload) {
+        size_t terms = 2 + rng() % 3;
+        for (size_t t = 0; t < terms; ++t) {
+            conditions.push_back({codes[rng() % codes.size()], 6.0 + (rng() % 31) / 10.0});
+        }
+    }
+    
+    std::cout << "students=" << count << " queries=" << queries << " (2-4 conditions each)"
+              << std::endl;
+    int status = 0;
+    for (GradeMatch match : {GradeMatch::All, GradeMatch::Any}) {
+        size_t composedHits = 0;
+        std::vector<std::vector<StudentHandle>> composed;
+        double composedSeconds = bench::timeSeconds([&] {
+            for (const auto& conditions : workload) {
+                composed.push_back(composeRanges(registry, conditions, match));
+                composedHits += composed.back().size();
+            }
+        });
+        
+        size_t batchedHits = 0;
+        bool same = true;
+        size_t index = 0;
+        double batchedSeconds = bench::timeSeconds([&] {
+            for (const auto& conditions : workload) {
+                auto handles = registry.matchGrades(conditions, match);
+                batchedHits += handles.size();
+                same = same && handles == composed[index++];
+            }
+        });
+        if (!same) status = 1;
+        
+        std::cout << (match == GradeMatch::All ? "AND" : "OR ") << std::fixed
+                  << std::setprecision(3) << "  gradeRange + set ops "
+                  << composedSeconds * 1000.0 / queries << " ms/query"
+                  << "  matchGrades " << batchedSeconds * 1000.0 / queries << " ms/query"
+                  << "  avg hits " << batchedHits / queries
+                  << (same ? "" : "  RESULT MISMATCH") << std::endl;
+    }
+    return status;
+}
@@ -0,0 +1,94 @@
+#include "BenchCommon.h"
+#include "../StudentRegistry.h"
+#include <thread>
+
+using StudentPtr = std::shared_ptr<Student<std::string, std::string>>;
+
+namespace {
+
+// The chunk-sort + linear k-way scan merge parallelSort used before the
+// parallel merge, kept here as the baseline. Like the original it needs at
+// least numThreads students.
+void legacyParallelSort(std::vector<StudentPtr>& students, int numThreads) {
+    size_t chunkSize = std::max<size_t>(1, students.size() / numThreads);
+    std::vector<std::vector<StudentPtr>> chunks(numThreads);
+    for (int i = 0; i < numThreads; ++i) {
+        size_t start = i * chunkSize;
+        size_t end = (i == numThreads - 1) ? students.size() : (i + 1) * chunkSize;
+        chunks[i].assign(students.begin() + start, students.begin() + end);
+    }
+    std::vector<std::thread> threads;
+    for (int i = 0; i < numThreads; ++i) {
+        threads.emplace_back([&chunks, i]() {
+            std::sort(chunks[i].begin(), chunks[i].end(),
+                      [](const StudentPtr& a, const StudentPtr& b) { return *a < *b; });
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    std::vector<StudentPtr> result;
+    std::vector<size_t> indices(numThreads, 0);
+    while (result.size() < students.size()) {
+        int bestChunk = -1;
+        StudentPtr bestStudent = nullptr;
+        for (int i = 0; i < numThreads; ++i) {
+            if (indices[i] < chunks[i].size() &&
+                (bestChunk == -1 || *chunks[i][indices[i]] < *bestStudent)) {
+                bestChunk = i;
+                bestStudent = chunks[i][indices[i]];
+            }
+        }
+        result.push_back(bestStudent);
+        indices[bestChunk]++;
+    }
+    students = result;
+}
+
+bool sameOrder(const std::vector<StudentPtr>& a, const std::vector<StudentPtr>& b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (*a[i] < *b[i] || *b[i] < *a[i]) return false;
+    }
+    return true;
+}
+
+}
+
+int main(int argc, char** argv) {
+    size_t count = bench::sizeArg(argc, argv, 1, 1000000);
+    int maxThreads = static_cast<int>(bench::sizeArg(argc, argv, 2, 16));
+    auto input = bench::makeStudents(count);
+    std::cout << "students=" << count << " hardware threads="
+              << std::thread::hardware_concurrency() << std::endl;
+    
+    int status = 0;
+    for (int threads = 1; threads <= maxThreads; threads *= 2) {
+        auto legacy = input;
+        std::sort(legacy.begin(), legacy.end(),
+                  [](const StudentPtr& a, const StudentPtr& b) { return *a < *b; });
+        double legacySeconds = 0.0;
+        if (static_cast<size_t>(threads) <= count) {
+            legacy = input;
+            legacySeconds = bench::timeSeconds([&] {
+                legacyParallelSort(legacy, threads);
+            });
+        }
+        
+        auto sorted = input;
+        std::vector<std::chrono::microseconds> threadTimes;
+        SortPhaseTimes phases;
+        StudentRegistry<std::string, std::string>::parallelSort(sorted, threads, threadTimes,
+                                                                 phases);
+        bool same = sameOrder(sorted, legacy);
+        if (!same) status = 1;
+        
+        std::cout << "threads=" << std::setw(2) << threads << std::fixed << std::setprecision(1)
+                  << "  legacy " << std::setw(8) << legacySeconds * 1000.0 << " ms"
+                  << "  parallel merge " << std::setw(8) << phases.total.count() / 1000.0
+                  << " ms (sort " << phases.sort.count() / 1000.0
+                  << ", merge " << phases.merge.count() / 1000.0 << ")"
+                  << (same ? "" : "  ORDER MISMATCH") << std::endl;
+    }
+    return status;
+}
@@ -0,0 +1,185 @@
+#include "BenchCommon.h"
+#include "../QueryServer.h"
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <thread>
+
+// Load generator for the query server:
+//   bench_query_server [students=100000] [connections=4] [requests=100000]
+//                      [depth=16] [socket]
+// Without a socket path it serves a generated dataset from an in-process
+// QueryServer on a temporary socket. Each connection keeps up to depth
+// requests in flight (a mix of GRADE, ROLL and RANGE), and the latency of a
+// request runs from its send to the arrival of its response line. Runs
+// once without pipelining (depth 1) and once at depth, and reports QPS and
+// p50/p99 latency for each.
+
+namespace {
+
+struct ClientResult {
+    std::vector<double> latencies;
+    size_t errors = 0;
+};
+
+bool connectTo(const std::string& path, int& fd) {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    std::strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+    fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    return fd >= 0 &&
+           connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0;
+}
+
+bool sendAll(int fd, const std::string& data) {
+    size_t sent = 0;
+    while (sent < data.size()) {
+        ssize_t n = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        sent += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+std::string makeRequest(std::mt19937_64& rng) {
+    const auto& codes = bench::courseCodes();
+    switch (rng() % 10) {
+        case 0:
+            return "ROLL " + bench::makeRollNumber(rng) + "\n";
+        case 1: {
+            std::string from = bench::makeRollNumber(rng);
+            return "RANGE " + from + " " + from + "9 20\n";
+        }
+        default: {
+            size_t tenths = 80 + rng() % 21;
+            return "GRADE " + codes[rng() % codes.size()] + " " + std::to_string(tenths / 10) +
+                   "." + std::to_string(tenths % 10) + " 20\n";
+        }
+    }
+}
+
+// Sends requests over one connection keeping up to depth in flight.
+ClientResult runClient(const std::string& path, size_t requests, size_t depth,
+                       unsigned seed) {
+    ClientResult result;
+    int fd = -1;
+    if (!connectTo(path, fd)) {
+        result.errors = requests;
+        if (fd >= 0) close(fd);
+        return result;
+    }
+    std::mt19937_64 rng(seed);
+    std::deque<bench::Clock::time_point> inFlight;
+    result.latencies.reserve(requests);
+    size_t sent = 0;
+    std::string buffer;
+    char chunk[65536];
+    while (result.latencies.size() + result.errors < requests) {
+        std::string batch;
+        auto now = bench::Clock::now();
+        while (sent < requests && inFlight.size() < depth) {
+            batch += makeRequest(rng);
+            inFlight.push_back(now);
+            sent++;
+        }
+        if (!batch.empty() && !sendAll(fd, batch)) break;
+
+        ssize_t received = recv(fd, chunk, sizeof(chunk), 0);
+        if (received < 0 && errno == EINTR) continue;
+        if (received <= 0) break;
+        auto arrived = bench::Clock::now();
+        buffer.append(chunk, static_cast<size_t>(received));
+        size_t start = 0;
+        for (size_t end; (end = buffer.find('\n', start)) != std::string::npos; start = end + 1) {
+            std::string_view line(buffer.data() + start, end - start);
+            if (line.compare(0, 2, "OK") == 0 || line == "NONE") {
+                result.latencies.push_back(
+                    std::chrono::duration<double, std::micro>(arrived - inFlight.front()).count());
+            } else {
+                result.errors++;
+            }
+            inFlight.pop_front();
+        }
+        buffer.erase(0, start);
+    }
+    result.errors += requests - result.latencies.size() - result.errors;
+    close(fd);
+    return result;
+}
+
+// Runs connections clients at once and prints their combined numbers.
+// Returns the number of failed requests.
+size_t runLoad(const std::string& path, size_t connections, size_t requests, size_t depth) {
+    std::vector<ClientResult> results(connections);
+    std::vector<std::thread> clients;
+    double seconds = bench::timeSeconds([&] {
+        for (size_t c = 0; c < connections; ++c) {
+            size_t share = requests / connections + (c < requests % connections ? 1 : 0);
+            clients.emplace_back([&, c, share] {
+                results[c] = runClient(path, share, depth, static_cast<unsigned>(c + 1));
+            });
+        }
+        for (auto& client : clients) {
+            client.join();
+        }
+    });
+
+    std::vector<double> latencies;
+    size_t errors = 0;
+    for (const auto& result : results) {
+        latencies.insert(latencies.end(), result.latencies.begin(), result.latencies.end());
+        errors += result.errors;
+    }
+    std::sort(latencies.begin(), latencies.end());
+    auto percentile = [&latencies](double percent) {
+        if (latencies.empty()) return 0.0;
+        size_t rank = static_cast<size_t>(std::ceil(percent * latencies.size() / 100.0));
+        return latencies[std::clamp<size_t>(rank, 1, latencies.size()) - 1];
+    };
+    std::cout << "connections=" << connections << " depth=" << std::setw(3) << depth
+              << std::fixed << std::setprecision(1) << "  " << std::setw(10)
+              << latencies.size() / seconds << " queries/s  p50 " << std::setw(8)
+              << percentile(50.0) << " us  p99 " << std::setw(8) << percentile(99.0)
+              << " us  errors " << errors << std::endl;
+    return errors;
+}
+
+}
+
+int main(int argc, char** argv) {
+    size_t students = bench::sizeArg(argc, argv, 1, 100000);
+    size_t connections = std::max<size_t>(1, bench::sizeArg(argc, argv, 2, 4));
+    size_t requests = bench::sizeArg(argc, argv, 3, 100000);
+    size_t depth = std::max<size_t>(1, bench::sizeArg(argc, argv, 4, 16));
+
+    std::string path;
+    std::string csvPath;
+    std::unique_ptr<QueryServer::Dataset> dataset;
+    std::unique_ptr<QueryServer> server;
+    std::thread serverThread;
+    if (argc > 5) {
+        path = argv[5];
+    } else {
+        std::string suffix = std::to_string(getpid());
+        csvPath = "/tmp/erp_bench_server_" + suffix + ".csv";
+        path = "/tmp/erp_bench_server_" + suffix + ".sock";
+        bench::writeStudentsCsv(csvPath, students);
+        dataset = std::make_unique<QueryServer::Dataset>(csvPath);
+        dataset->get();
+        server = std::make_unique<QueryServer>(*dataset, path);
+        if (!server->start()) return 1;
+        serverThread = std::thread([&] { server->run(); });
+        std::cout << "students=" << students << " (in-process server)" << std::endl;
+    }
+
+    size_t errors = runLoad(path, connections, std::min<size_t>(requests, 20000), 1);
+    errors += runLoad(path, connections, requests, depth);
+
+    if (server) {
+        server->stop();
+        serverThread.join();
+        std::remove(csvPath.c_str());
+    }
+    return errors == 0 ? 0 : 1;
+}
@@ -0,0 +1,62 @@
+#include "BenchCommon.h"
+#include "../StudentRegistry.h"
+#include <thread>
+
+using StudentPtr = std::shared_ptr<Student<std::string, std::string>>;
+
+namespace {
+
+// Only the roll number matters to the sort, so students carry no courses
+// to keep 10M of them within memory.
+std::vector<StudentPtr> makeRollOnlyStudents(size_t count) {
+    std::mt19937_64 rng(42);
+    std::vector<StudentPtr> students;
+    students.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        students.push_back(std::make_shared<Student<std::string, std::string>>(
+            "", bench::makeRollNumber(rng), "", 2020));
+    }
+    return students;
+}
+
+double sortSeconds(std::vector<StudentPtr>& students, int threads, SortEngine engine) {
+    std::vector<std::chrono::microseconds> threadTimes;
+    SortPhaseTimes phases;
+    StudentRegistry<std::string, std::string>::parallelSort(students, threads, threadTimes,
+                                                             phases, engine);
+    return phases.total.count() / 1e6;
+}
+
+}
+
+int main(int argc, char** argv) {
+    int threads = static_cast<int>(bench::sizeArg(argc, argv, 1,
+                                                  std::thread::hardware_concurrency()));
+    std::vector<size_t> sizes;
+    for (int i = 2; i < argc; ++i) {
+        sizes.push_back(bench::sizeArg(argc, argv, i, 0));
+    }
+    if (sizes.empty()) sizes = {1000000, 10000000};
+    std::cout << "threads=" << threads << std::endl;
+    
+    int status = 0;
+    for (size_t count : sizes) {
+        std::vector<StudentPtr> byComparison = makeRollOnlyStudents(count);
+        std::vector<StudentPtr> byRadix = byComparison;
+        double comparisonSeconds = sortSeconds(byComparison, threads, SortEngine::Comparison);
+        double radixSeconds = sortSeconds(byRadix, threads, SortEngine::Radix);
+        
+        bool same = true;
+        for (size_t i = 0; same && i < count; ++i) {
+            same = byComparison[i]->getSortKey() == byRadix[i]->getSortKey();
+        }
+        if (!same) status = 1;
+        
+        std::cout << "n=" << std::setw(9) << count << std::fixed << std::setprecision(1)
+                  << "  comparison " << std::setw(8) << comparisonSeconds * 1000.0 << " ms"
+                  << "  radix " << std::setw(8) << radixSeconds * 1000.0 << " ms"
+                  << "  speedup " << std::setprecision(2) << comparisonSeconds / radixSeconds
+                  << "x" << (same ? "" : "  ORDER MISMATCH") << std::endl;
+    }
+    return status;
+}
@@ -0,0 +1,47 @@
+#include "BenchCommon.h"
+#include "../StudentRegistry.h"
+#include <algorithm>
+
+using Registry = StudentRegistry<std::string, std::string>;
+using StudentPtr = std::shared_ptr<Student<std::string, std::string>>;
+
+// Reproduces the previous addStudent behaviour: push, then sort the whole
+// vector on every insert.
+static void legacyLoad(const std::vector<StudentPtr>& students) {
+    std::vector<StudentPtr> sorted;
+    for (const auto& student : students) {
+        sorted.push_back(student);
+        std::sort(sorted.begin(), sorted.end(),
+                  [](const StudentPtr& a, const StudentPtr& b) { return *a < *b; });
+    }
+}
+
+int main(int argc, char** argv) {
+    size_t maxCount = bench::sizeArg(argc, argv, 1, 1000000);
+    size_t legacyLimit = bench::sizeArg(argc, argv, 2, 10000);
+    
+    for (size_t n : {size_t(10000), size_t(100000), size_t(1000000)}) {
+        if (n > maxCount) break;
+        auto students = bench::makeStudents(n);
+        
+        if (n <= legacyLimit) {
+            bench::report("legacy sort-per-insert load", n,
+                          bench::timeSeconds([&] { legacyLoad(students); }));
+        }
+        
+        bench::report("addStudent loop + sorted read", n, bench::timeSeconds([&] {
+            Registry registry;
+            for (const auto& student : students) {
+                registry.addStudent(student);
+            }
+            registry.sortedBegin();
+        }));
+        
+        bench::report("addStudents bulk + sorted read", n, bench::timeSeconds([&] {
+            Registry registry;
+            registry.addStudents(students);
+            registry.sortedBegin();
+        }));
+    }
+    return 0;
+}
@@ -0,0 +1,78 @@
+#include "BenchCommon.h"
+#include "../StudentRegistry.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <malloc.h>
+
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+
+static std::atomic<long long> liveBytes{0};
+
+void* operator new(size_t size) {
+    void* block = std::malloc(size ? size : 1);
+    if (!block) throw std::bad_alloc();
+    liveBytes += static_cast<long long>(malloc_usable_size(block));
+    return block;
+}
+
+void operator delete(void* ptr) noexcept {
+    if (!ptr) return;
+    liveBytes -= static_cast<long long>(malloc_usable_size(ptr));
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    operator delete(ptr);
+}
+
+using Registry = StudentRegistry<std::string, std::string>;
+
+int main(int argc, char** argv) {
+    size_t count = bench::sizeArg(argc, argv, 1, 200000);
+    size_t rounds = bench::sizeArg(argc, argv, 2, 20);
+    
+    long long before = liveBytes;
+    Registry registry;
+    {
+        auto students = bench::makeStudents(count);
+        registry.addStudents(students);
+    }
+    long long used = liveBytes - before;
+    std::cout << "registry footprint: " << std::fixed << std::setprecision(1)
+              << static_cast<double>(used) / count << " bytes/student (students + orders + index)"
+              << std::endl;
+    
+    long long checksum = 0;
+    double sortedSeconds = bench::timeSeconds([&] {
+        for (size_t r = 0; r < rounds; ++r) {
+            auto end = registry.sortedEnd();
+            for (auto it = registry.sortedBegin(); it != end; ++it) {
+                checksum += (*it)->getStartingYear();
+            }
+        }
+    });
+    double originalSeconds = bench::timeSeconds([&] {
+        for (size_t r = 0; r < rounds; ++r) {
+            auto end = registry.originalEnd();
+            for (auto it = registry.originalBegin(); it != end; ++it) {
+                checksum += (*it)->getStartingYear();
+            }
+        }
+    });
+    size_t hits = 0;
+    double querySeconds = bench::timeSeconds([&] {
+        for (size_t r = 0; r < rounds; ++r) {
+            hits += registry.getStudentsWithGrade("DSA", 9.0).size();
+        }
+    });
+    
+    double visited = static_cast<double>(count) * rounds;
+    std::cout << "sorted iteration:   " << visited / sortedSeconds / 1e6 << " M students/s\n"
+              << "original iteration: " << visited / originalSeconds / 1e6 << " M students/s\n"
+              << "getStudentsWithGrade(DSA, 9.0): "
+              << querySeconds / rounds * 1000.0 << " ms/query, "
+              << hits / rounds << " hits\n"
+              << "(checksum " << checksum << ")" << std::endl;
+    return 0;
+}
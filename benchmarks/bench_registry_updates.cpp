@@ -0,0 +1,252 @@
+#include "BenchCommon.h"
+#include "../StudentRegistry.h"
+#include <algorithm>
+#include <map>
+
+using Registry = StudentRegistry<std::string, std::string>;
+using StudentType = Student<std::string, std::string>;
+
+namespace {
+
+std::string describe(const StudentType& student) {
+    std::ostringstream out;
+    out << student;
+    return out.str();
+}
+
+// Compares the updated registry against one rebuilt from the expected
+// students. Handles differ between the two, so students are compared by
+// content: originals in order, sorted roll numbers in order, and each grade
+// query's (grade, student) pairs.
+bool sameContents(const Registry& updated, const Registry& rebuilt) {
+    std::vector<std::string> a;
+    std::vector<std::string> b;
+    for (const auto* student : updated.originalView()) a.push_back(describe(*student));
+    for (const auto* student : rebuilt.originalView()) b.push_back(describe(*student));
+    if (a != b) return false;
+
+    a.clear();
+    b.clear();
+    for (const auto* student : updated.sortedView()) a.push_back(student->getRollNumber());
+    for (const auto* student : rebuilt.sortedView()) b.push_back(student->getRollNumber());
+    if (a != b) return false;
+
+    for (const auto& code : bench::courseCodes()) {
+        for (double minGrade : {0.0, 7.5, 9.0}) {
+            std::multimap<double, std::string> x;
+            std::multimap<double, std::string> y;
+            auto ra = updated.gradeRange(code, minGrade);
+            for (auto it = ra.begin(); it != ra.end(); ++it) x.emplace(it.grade(), describe(**it));
+            auto rb = rebuilt.gradeRange(code, minGrade);
+            for (auto it = rb.begin(); it != rb.end(); ++it) y.emplace(it.grade(), describe(**it));
+            std::vector<std::pair<double, std::string>> xs(x.begin(), x.end());
+            std::vector<std::pair<double, std::string>> ys(y.begin(), y.end());
+            std::sort(xs.begin(), xs.end());
+            std::sort(ys.begin(), ys.end());
+            if (xs != ys) return false;
+        }
+    }
+    return true;
+}
+
+// A default-constructed course key (noCourse) is kept on the student but
+// never posted, through adds, grade updates, renames and removal.
+bool ignoresDefaultCourse(const std::string& code) {
+    StudentType student("Default Key", "D0001", "CSE", 2020);
+    student.addPreviousCourse(CourseKey<std::string>(), 5.0);
+    student.addPreviousCourse(code, 6.0);
+    Registry registry;
+    StudentHandle handle = registry.addStudent(student);
+    bool ok = registry.gradeRange(code, 0.0).size() == 1;
+    registry.updateGrade(handle, code, 8.0);
+    ok = ok && registry.gradeRange(code, 7.0).size() == 1;
+    auto renamed = registry.changeRollNumber(handle, "D0002");
+    ok = ok && renamed && registry.gradeRange(code, 7.0).size() == 1;
+    ok = ok && renamed && registry.removeStudent(*renamed);
+    return ok && registry.gradeRange(code, 0.0).size() == 0;
+}
+
+}
+
+int main(int argc, char** argv) {
+    size_t count = bench::sizeArg(argc, argv, 1, 200000);
+    size_t updates = bench::sizeArg(argc, argv, 2, 100000);
+    const auto& codes = bench::courseCodes();
+
+    auto input = bench::makeStudents(count);
+    Registry registry;
+    registry.addStudents(input);
+    registry.sortedView();
+    for (const auto& code : codes) {
+        registry.gradeRange(code, 0.0);
+    }
+
+    // The expected final students, in original order, mirror every update.
+    std::vector<std::optional<StudentType>> expected;
+    for (const auto& student : input) {
+        expected.emplace_back(*student);
+    }
+
+    std::mt19937_64 rng(17);
+    std::vector<Registry::GradeUpdate> posting;
+    for (size_t i = 0; i < updates; ++i) {
+        StudentHandle handle = static_cast<StudentHandle>(rng() % count);
+        posting.push_back({handle, codes[rng() % codes.size()], bench::makeGrade(rng)});
+    }
+    double postingSeconds = bench::timeSeconds([&] {
+        registry.updateGrades(posting);
+    });
+    auto expectUpdate = [&expected](const Registry::GradeUpdate& update) {
+        StudentType& student = *expected[update.student];
+        CourseKey<std::string> key(update.course);
+        if (student.getPreviousCourses().count(key) == 0 &&
+            student.getCurrentCourses().count(key) != 0) {
+            student.addCurrentCourse(key, update.grade);
+        } else {
+            student.addPreviousCourse(key, update.grade);
+        }
+    };
+    for (const auto& update : posting) {
+        expectUpdate(update);
+    }
+
+    // Single updates each followed by a read, as a server applying edits
+    // between queries sees them: half by a roll-number lookup, half by a
+    // grade query on the updated course.
+    size_t singles = std::max<size_t>(1, updates / 10);
+    std::vector<Registry::GradeUpdate> interleaved;
+    for (size_t i = 0; i < 2 * singles; ++i) {
+        StudentHandle handle = static_cast<StudentHandle>(rng() % count);
+        interleaved.push_back({handle, codes[rng() % codes.size()], bench::makeGrade(rng)});
+    }
+    size_t found = 0;
+    double lookupSeconds = bench::timeSeconds([&] {
+        for (size_t i = 0; i < singles; ++i) {
+            const auto& update = interleaved[i];
+            registry.updateGrade(update.student, update.course, update.grade);
+            found += registry.findByRollNumber(input[update.student]->getRollNumber()) != nullptr;
+        }
+    });
+    double querySeconds = bench::timeSeconds([&] {
+        for (size_t i = singles; i < 2 * singles; ++i) {
+            const auto& update = interleaved[i];
+            registry.updateGrade(update.student, update.course, update.grade);
+            found += registry.gradeRange(update.course, 9.0).size();
+        }
+    });
+    for (const auto& update : interleaved) {
+        expectUpdate(update);
+    }
+
+    std::vector<std::pair<StudentHandle, std::string>> completions;
+    std::vector<std::pair<StudentHandle, std::string>> renames;
+    std::vector<StudentHandle> removals;
+    for (size_t i = 0; i < singles; ++i) {
+        completions.emplace_back(rng() % count, codes[rng() % codes.size()]);
+        renames.emplace_back(rng() % count, bench::makeRollNumber(rng));
+        removals.push_back(static_cast<StudentHandle>(rng() % count));
+    }
+    double completeSeconds = bench::timeSeconds([&] {
+        for (const auto& completion : completions) {
+            registry.completeCourse(completion.first, completion.second);
+        }
+    });
+    double renameSeconds = bench::timeSeconds([&] {
+        for (const auto& rename : renames) {
+            registry.changeRollNumber(rename.first, rename.second);
+        }
+    });
+    double removeSeconds = bench::timeSeconds([&] {
+        for (StudentHandle handle : removals) {
+            registry.removeStudent(handle);
+        }
+    });
+    for (const auto& completion : completions) {
+        expected[completion.first]->completeCourse(completion.second);
+    }
+    for (const auto& rename : renames) {
+        expected[rename.first]->setRollNumber(rename.second);
+    }
+    for (StudentHandle handle : removals) {
+        expected[handle].reset();
+    }
+
+    // The deferred work lands on the first reads.
+    double catchUpSeconds = bench::timeSeconds([&] {
+        registry.sortedView();
+        for (const auto& code : codes) {
+            registry.gradeRange(code, 0.0);
+        }
+    });
+
+    // A roll-number change or removal between every two ordered reads: each
+    // read rewrites the order lists, so these cost O(n) per pair rather than
+    // the batched per-op cost above.
+    size_t paired = std::min<size_t>(singles, 1000);
+    std::vector<std::pair<StudentHandle, std::string>> pairedRenames;
+    std::vector<StudentHandle> pairedRemovals;
+    for (size_t i = 0; i < paired; ++i) {
+        pairedRenames.emplace_back(rng() % count, bench::makeRollNumber(rng));
+        pairedRemovals.push_back(static_cast<StudentHandle>(rng() % count));
+    }
+    double pairedRenameSeconds = bench::timeSeconds([&] {
+        for (const auto& rename : pairedRenames) {
+            registry.changeRollNumber(rename.first, rename.second);
+            found += registry.findByRollNumber(rename.second) != nullptr;
+        }
+    });
+    double pairedRemoveSeconds = bench::timeSeconds([&] {
+        for (StudentHandle handle : pairedRemovals) {
+            registry.removeStudent(handle);
+            found += registry.findByRollNumber(input[handle]->getRollNumber()) != nullptr;
+        }
+    });
+    for (const auto& rename : pairedRenames) {
+        if (expected[rename.first]) expected[rename.first]->setRollNumber(rename.second);
+    }
+    for (StudentHandle handle : pairedRemovals) {
+        expected[handle].reset();
+    }
+
+    Registry rebuilt;
+    double rebuildSeconds = bench::timeSeconds([&] {
+        for (const auto& student : expected) {
+            if (student) rebuilt.addStudent(*student);
+        }
+        rebuilt.sortedView();
+        for (const auto& code : codes) {
+            rebuilt.gradeRange(code, 0.0);
+        }
+    });
+    bool same = sameContents(registry, rebuilt);
+
+    size_t reclaimed = 0;
+    double compactSeconds = bench::timeSeconds([&] {
+        reclaimed = registry.compactVersions();
+    });
+    bool sameAfterCompact = sameContents(registry, rebuilt);
+    bool defaultIgnored = ignoresDefaultCourse(codes.front());
+
+    std::cout << "students=" << count << " grade updates=" << updates << " other ops="
+              << singles << " each\n" << std::fixed << std::setprecision(3)
+              << "updateGrades (batch): " << postingSeconds * 1e6 / updates << " us/update\n"
+              << "updateGrade + lookup: " << lookupSeconds * 1e6 / singles << " us/op\n"
+              << "updateGrade + query:  " << querySeconds * 1e6 / singles << " us/op ("
+              << found << " hits)\n"
+              << "completeCourse:       " << completeSeconds * 1e6 / singles << " us/op\n"
+              << "changeRollNumber:     " << renameSeconds * 1e6 / singles << " us/op\n"
+              << "removeStudent:        " << removeSeconds * 1e6 / singles << " us/op\n"
+              << "first reads after:    " << catchUpSeconds * 1000.0 << " ms\n"
+              << "changeRollNumber + lookup: " << pairedRenameSeconds * 1e6 / paired
+              << " us/op (" << paired << " pairs)\n"
+              << "removeStudent + lookup:    " << pairedRemoveSeconds * 1e6 / paired
+              << " us/op\n"
+              << "full rebuild:         " << rebuildSeconds * 1000.0 << " ms\n"
+              << "compactVersions:      " << compactSeconds * 1000.0 << " ms, " << reclaimed
+              << " records reclaimed\n"
+              << (same && sameAfterCompact ? "contents match a rebuilt registry"
+                                           : "CONTENTS MISMATCH") << "\n"
+              << (defaultIgnored ? "default course key not posted"
+                                 : "DEFAULT COURSE KEY POSTED") << std::endl;
+    return same && sameAfterCompact && defaultIgnored ? 0 : 1;
+}
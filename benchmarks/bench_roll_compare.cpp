@@ -0,0 +1,91 @@
+#include "BenchCommon.h"
+#include <algorithm>
+
+using StudentSS = Student<std::string, std::string>;
+
+// The comparator Student::operator< used before sort keys were cached.
+static bool isNumericString(const std::string& str) {
+    return !str.empty() && std::all_of(str.begin(), str.end(), ::isdigit);
+}
+
+static bool legacyCompareRollNumbers(const std::string& a, const std::string& b) {
+    bool aIsNumeric = isNumericString(a);
+    bool bIsNumeric = isNumericString(b);
+    
+    if (aIsNumeric && bIsNumeric) {
+        try {
+            return std::stoll(a) < std::stoll(b);
+        } catch (...) {
+            if (a.length() != b.length()) return a.length() < b.length();
+            return a < b;
+        }
+    }
+    if (aIsNumeric != bIsNumeric) return aIsNumeric;
+    
+    size_t aPos = 0, bPos = 0;
+    while (aPos < a.length() && bPos < b.length()) {
+        bool aIsDigit = std::isdigit(static_cast<unsigned char>(a[aPos]));
+        bool bIsDigit = std::isdigit(static_cast<unsigned char>(b[bPos]));
+        if (aIsDigit && bIsDigit) {
+            size_t aNumStart = aPos, bNumStart = bPos;
+            while (aPos < a.length() && std::isdigit(static_cast<unsigned char>(a[aPos]))) aPos++;
+            while (bPos < b.length() && std::isdigit(static_cast<unsigned char>(b[bPos]))) bPos++;
+            std::string aNum = a.substr(aNumStart, aPos - aNumStart);
+            std::string bNum = b.substr(bNumStart, bPos - bNumStart);
+            if (aNum.length() != bNum.length()) return aNum.length() < bNum.length();
+            if (aNum != bNum) return aNum < bNum;
+        } else {
+            if (a[aPos] != b[bPos]) return a[aPos] < b[bPos];
+            aPos++;
+            bPos++;
+        }
+    }
+    return a.length() < b.length();
+}
+
+int main(int argc, char** argv) {
+    size_t count = bench::sizeArg(argc, argv, 1, 200000);
+    size_t rounds = bench::sizeArg(argc, argv, 2, 20);
+    
+    std::mt19937_64 rng(7);
+    std::vector<StudentSS> students;
+    students.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        students.emplace_back("S", bench::makeRollNumber(rng), "CSE", 2020);
+    }
+    
+    size_t mismatches = 0;
+    for (size_t i = 0; i + 1 < count; ++i) {
+        const auto& a = students[i];
+        const auto& b = students[i + 1];
+        if ((a < b) != legacyCompareRollNumbers(a.getRollNumber(), b.getRollNumber())) {
+            mismatches++;
+        }
+    }
+    std::cout << "order mismatches vs legacy comparator: " << mismatches << std::endl;
+    
+    size_t comparisons = (count - 1) * rounds;
+    size_t sink = 0;
+    double legacySeconds = bench::timeSeconds([&] {
+        for (size_t r = 0; r < rounds; ++r) {
+            for (size_t i = 0; i + 1 < count; ++i) {
+                sink += legacyCompareRollNumbers(students[i].getRollNumber(),
+                                                 students[i + 1].getRollNumber());
+            }
+        }
+    });
+    double keySeconds = bench::timeSeconds([&] {
+        for (size_t r = 0; r < rounds; ++r) {
+            for (size_t i = 0; i + 1 < count; ++i) {
+                sink += students[i] < students[i + 1];
+            }
+        }
+    });
+    
+    std::cout << "legacy compareRollNumbers: " << std::fixed << std::setprecision(1)
+              << comparisons / legacySeconds / 1e6 << " M comparisons/s" << std::endl;
+    std::cout << "precomputed sort key:      "
+              << comparisons / keySeconds / 1e6 << " M comparisons/s" << std::endl;
+    std::cout << "(checksum " << sink << ")" << std::endl;
+    return mismatches == 0 ? 0 : 1;
+}
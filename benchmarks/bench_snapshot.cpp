@@ -0,0 +1,79 @@
+#include "BenchCommon.h"
+#include "../CSVReader.h"
+#include "../StudentRegistry.h"
+#include <thread>
+
+using Registry = StudentRegistry<std::string, std::string>;
+
+namespace {
+
+// A registry is ready to serve once its sorted order is merged and every
+// course's grade column is flushed.
+void warm(const Registry& registry) {
+    registry.sortedView();
+    for (const auto& code : bench::courseCodes()) {
+        registry.gradeRange(code, 0.0);
+    }
+}
+
+bool sameContents(const Registry& a, const Registry& b) {
+    auto viewA = a.sortedView();
+    auto viewB = b.sortedView();
+    if (viewA.size() != viewB.size()) return false;
+    for (auto itA = viewA.begin(), itB = viewB.begin(); itA != viewA.end(); ++itA, ++itB) {
+        if ((*itA)->getRollNumber() != (*itB)->getRollNumber() ||
+            (*itA)->getName() != (*itB)->getName() ||
+            (*itA)->getGrade(std::string("DSA")) != (*itB)->getGrade(std::string("DSA"))) {
+            return false;
+        }
+    }
+    for (const auto& code : bench::courseCodes()) {
+        auto rangeA = a.gradeRange(code, 7.5);
+        auto rangeB = b.gradeRange(code, 7.5);
+        if (rangeA.size() != rangeB.size()) return false;
+        for (auto itA = rangeA.begin(), itB = rangeB.begin(); itA != rangeA.end(); ++itA, ++itB) {
+            if (itA.grade() != itB.grade() || itA.handle() != itB.handle()) return false;
+        }
+    }
+    return true;
+}
+
+}
+
+int main(int argc, char** argv) {
+    size_t rows = bench::sizeArg(argc, argv, 1, 1000000);
+    int threads = static_cast<int>(bench::sizeArg(argc, argv, 2,
+                                                  std::thread::hardware_concurrency()));
+    std::string csvPath = "/tmp/erp_bench_snapshot.csv";
+    std::string snapshotPath = "/tmp/erp_bench_snapshot.bin";
+    bench::writeStudentsCsv(csvPath, rows);
+    
+    Registry fromCsv;
+    double csvSeconds = bench::timeSeconds([&] {
+        fromCsv.addStudents(CSVReader::read<std::string, std::string>(csvPath, threads));
+        warm(fromCsv);
+    });
+    double saveSeconds = bench::timeSeconds([&] { fromCsv.saveSnapshot(snapshotPath); });
+    
+    Registry fromSnapshot;
+    bool loaded = false;
+    double loadSeconds = bench::timeSeconds([&] {
+        loaded = fromSnapshot.loadSnapshot(snapshotPath);
+        warm(fromSnapshot);
+    });
+    bool same = loaded && sameContents(fromCsv, fromSnapshot);
+    
+    std::cout << std::fixed << std::setprecision(1)
+              << "students=" << rows << " threads=" << threads
+              << " csv=" << bench::fileMegabytes(csvPath) << " MB"
+              << " snapshot=" << bench::fileMegabytes(snapshotPath) << " MB\n"
+              << "CSV cold load (parse + sort + index): " << csvSeconds * 1000.0 << " ms\n"
+              << "saveSnapshot:                         " << saveSeconds * 1000.0 << " ms\n"
+              << "loadSnapshot:                         " << loadSeconds * 1000.0 << " ms"
+              << "  (" << std::setprecision(2) << csvSeconds / loadSeconds << "x faster)"
+              << (same ? "" : "  CONTENTS DIFFER") << std::endl;
+    
+    std::remove(csvPath.c_str());
+    std::remove(snapshotPath.c_str());
+    return same ? 0 : 1;
+}
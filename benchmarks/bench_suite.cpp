@@ -0,0 +1,149 @@
+#include "BenchCommon.h"
+#include "../CSVReader.h"
+#include "../StudentRegistry.h"
+#include <cstdio>
+
+// End-to-end suite over one synthetic dataset: CSV parse, bulk load,
+// parallelSort per engine and thread count, and getStudentsWithGrade QPS.
+// Each result is one JSON object per line, for regression tracking:
+//   bench_suite [rows=100000] [maxThreads=8] [queries=2000] [csv]
+// If csv is given it is parsed instead of a generated file.
+
+using Registry = StudentRegistry<std::string, std::string>;
+using StudentPtr = std::shared_ptr<Student<std::string, std::string>>;
+
+namespace {
+
+struct Result {
+    std::string name;
+    size_t rows = 0;
+    int threads = 1;
+    double seconds = 0.0;
+    double items = 0.0;
+    double bytes = 0.0;
+};
+
+void emit(const Result& result) {
+    std::cout << std::fixed << std::setprecision(3) << "{\"name\":\"" << result.name
+              << "\",\"rows\":" << result.rows << ",\"threads\":" << result.threads
+              << ",\"real_time_ms\":" << result.seconds * 1000.0
+              << ",\"items_per_second\":" << result.items / result.seconds;
+    if (result.bytes > 0.0) {
+        std::cout << ",\"mb_per_second\":" << result.bytes / 1e6 / result.seconds;
+    }
+    std::cout << "}" << std::endl;
+}
+
+std::vector<int> threadCounts(int maxThreads) {
+    std::vector<int> counts;
+    for (int threads = 1; threads <= maxThreads; threads *= 2) {
+        counts.push_back(threads);
+    }
+    return counts;
+}
+
+// Parses path once per thread count; returns false if any pass drops rows.
+template<typename R, typename C>
+bool benchParse(const std::string& name, const std::string& path, size_t expectedRows,
+                int maxThreads) {
+    double bytes = bench::fileMegabytes(path) * 1024.0 * 1024.0;
+    bool ok = true;
+    for (int threads : threadCounts(maxThreads)) {
+        CSVReadStats stats;
+        size_t rows = 0;
+        double seconds = bench::timeSeconds([&] {
+            rows = CSVReader::read<R, C>(path, threads, &stats).size();
+        });
+        ok = ok && (expectedRows == 0 || rows == expectedRows) && stats.entriesRejected == 0;
+        emit({name, rows, threads, seconds, static_cast<double>(rows), bytes});
+    }
+    return ok;
+}
+
+}
+
+int main(int argc, char** argv) {
+    size_t rows = bench::sizeArg(argc, argv, 1, 100000);
+    int maxThreads = static_cast<int>(std::max<size_t>(1, bench::sizeArg(argc, argv, 2, 8)));
+    size_t queries = std::max<size_t>(1, bench::sizeArg(argc, argv, 3, 2000));
+    bool generated = argc <= 4;
+    std::string path = generated ? "/tmp/erp_bench_suite.csv" : argv[4];
+    std::string numericPath = "/tmp/erp_bench_suite_int.csv";
+
+    bool ok = true;
+    if (generated) {
+        bench::writeStudentsCsv(path, rows);
+        bench::writeStudentsCsv(numericPath, rows, 42, true);
+        ok = benchParse<std::string, std::string>("csv_parse/string_courses", path, rows,
+                                                  maxThreads);
+        ok = benchParse<std::string, int>("csv_parse/int_courses", numericPath, rows,
+                                          maxThreads) && ok;
+        std::remove(numericPath.c_str());
+    } else {
+        ok = benchParse<std::string, std::string>("csv_parse/string_courses", path, 0,
+                                                  maxThreads);
+    }
+
+    std::vector<StudentPtr> students = CSVReader::read<std::string, std::string>(
+        path, maxThreads);
+    if (generated) {
+        std::remove(path.c_str());
+    }
+    rows = students.size();
+
+    double seconds = bench::timeSeconds([&] {
+        Registry registry;
+        for (const auto& student : students) {
+            registry.addStudent(student);
+        }
+        registry.sortedBegin();
+    });
+    emit({"load/add_student_loop", rows, 1, seconds, static_cast<double>(rows)});
+
+    Registry registry;
+    seconds = bench::timeSeconds([&] {
+        registry.addStudents(students);
+        registry.sortedBegin();
+    });
+    emit({"load/add_students_bulk", rows, 1, seconds, static_cast<double>(rows)});
+
+    for (SortEngine engine : {SortEngine::Comparison, SortEngine::Radix}) {
+        const char* name = engine == SortEngine::Radix ? "parallel_sort/radix"
+                                                       : "parallel_sort/comparison";
+        for (int threads : threadCounts(maxThreads)) {
+            auto sorted = students;
+            std::vector<std::chrono::microseconds> threadTimes;
+            SortPhaseTimes phases;
+            seconds = bench::timeSeconds([&] {
+                Registry::parallelSort(sorted, threads, threadTimes, phases, engine);
+            });
+            ok = ok && std::is_sorted(sorted.begin(), sorted.end(),
+                                      [](const StudentPtr& a, const StudentPtr& b) {
+                                          return *a < *b;
+                                      });
+            emit({name, rows, threads, seconds, static_cast<double>(rows)});
+        }
+    }
+
+    std::mt19937_64 rng(5);
+    const auto& codes = bench::courseCodes();
+    std::vector<std::pair<std::string, double>> workload;
+    for (size_t i = 0; i < queries; ++i) {
+        workload.emplace_back(codes[rng() % codes.size()], 8.0 + (rng() % 21) / 10.0);
+    }
+    for (const auto& code : codes) {
+        registry.gradeRange(code, 0.0);
+    }
+    size_t hits = 0;
+    seconds = bench::timeSeconds([&] {
+        for (const auto& query : workload) {
+            hits += registry.getStudentsWithGrade(query.first, query.second).size();
+        }
+    });
+    emit({"query/get_students_with_grade", rows, 1, seconds, static_cast<double>(queries)});
+
+    if (!ok) {
+        std::cerr << "bench_suite: a parse dropped rows or a sort was out of order" << std::endl;
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,152 @@
+#include "BenchCommon.h"
+#include "../StudentRegistry.h"
+#include <thread>
+
+using StudentPtr = std::shared_ptr<Student<std::string, std::string>>;
+
+namespace {
+
+// parallelSort as it was before the thread pool: fresh std::threads for the
+// chunk sorts and for every merge round of every call.
+template<typename T, typename Compare>
+void spawnMergeRuns(std::vector<T>& data, std::vector<size_t> bounds,
+                    int numThreads, Compare less) {
+    if (numThreads < 1) numThreads = 1;
+    if (bounds.size() <= 2) return;
+    
+    struct Piece {
+        size_t aBegin, aEnd, bBegin, bEnd, out;
+    };
+    
+    std::vector<T> buffer(data.size());
+    std::vector<T>* from = &data;
+    std::vector<T>* to = &buffer;
+    const size_t total = data.size();
+    
+    while (bounds.size() > 2) {
+        std::vector<Piece> pieces;
+        std::vector<size_t> nextBounds = {0};
+        for (size_t run = 0; run + 1 < bounds.size(); run += 2) {
+            size_t aBegin = bounds[run];
+            size_t aEnd = bounds[run + 1];
+            size_t bEnd = run + 2 < bounds.size() ? bounds[run + 2] : aEnd;
+            size_t pairSize = bEnd - aBegin;
+            size_t parts = std::max<size_t>(1, (pairSize * numThreads + total - 1) / total);
+            
+            auto a = from->begin() + aBegin;
+            auto b = from->begin() + aEnd;
+            size_t aSize = aEnd - aBegin;
+            size_t bSize = bEnd - aEnd;
+            size_t previousRank = 0;
+            size_t previousSplit = 0;
+            for (size_t part = 1; part <= parts; ++part) {
+                size_t rank = pairSize * part / parts;
+                size_t split = coRank(rank, a, aSize, b, bSize, less);
+                pieces.push_back({aBegin + previousSplit, aBegin + split,
+                                  aEnd + (previousRank - previousSplit), aEnd + (rank - split),
+                                  aBegin + previousRank});
+                previousRank = rank;
+                previousSplit = split;
+            }
+            nextBounds.push_back(bEnd);
+        }
+        
+        auto mergePiece = [from, to, &less](const Piece& piece) {
+            std::merge(std::make_move_iterator(from->begin() + piece.aBegin),
+                       std::make_move_iterator(from->begin() + piece.aEnd),
+                       std::make_move_iterator(from->begin() + piece.bBegin),
+                       std::make_move_iterator(from->begin() + piece.bEnd),
+                       to->begin() + piece.out, less);
+        };
+        
+        size_t workers = std::min(pieces.size(), static_cast<size_t>(numThreads));
+        std::vector<std::thread> threads;
+        for (size_t worker = 1; worker < workers; ++worker) {
+            threads.emplace_back([&pieces, &mergePiece, worker, workers]() {
+                for (size_t i = worker; i < pieces.size(); i += workers) {
+                    mergePiece(pieces[i]);
+                }
+            });
+        }
+        for (size_t i = 0; i < pieces.size(); i += workers) {
+            mergePiece(pieces[i]);
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        
+        bounds = std::move(nextBounds);
+        std::swap(from, to);
+    }
+    
+    if (from != &data) {
+        data.swap(buffer);
+    }
+}
+
+
+void spawnPerCallSort(std::vector<StudentPtr>& students, int numThreads) {
+    numThreads = static_cast<int>(std::min<size_t>(numThreads, students.size()));
+    if (numThreads < 1) return;
+    auto less = [](const StudentPtr& a, const StudentPtr& b) { return *a < *b; };
+    std::vector<size_t> bounds(numThreads + 1);
+    for (int i = 0; i <= numThreads; ++i) {
+        bounds[i] = students.size() * i / numThreads;
+    }
+    std::vector<std::thread> threads;
+    for (int i = 1; i < numThreads; ++i) {
+        threads.emplace_back([&, i]() {
+            std::sort(students.begin() + bounds[i], students.begin() + bounds[i + 1], less);
+        });
+    }
+    std::sort(students.begin() + bounds[0], students.begin() + bounds[1], less);
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    spawnMergeRuns(students, bounds, numThreads, less);
+}
+
+}
+
+int main(int argc, char** argv) {
+    size_t count = bench::sizeArg(argc, argv, 1, 2000);
+    size_t repeats = bench::sizeArg(argc, argv, 2, 1000);
+    int maxThreads = static_cast<int>(bench::sizeArg(argc, argv, 3, 8));
+    auto input = bench::makeStudents(count);
+    std::cout << "students=" << count << " sorts=" << repeats << " pool threads="
+              << ThreadPool::instance().size() << std::endl;
+    
+    int status = 0;
+    for (int threads = 1; threads <= maxThreads; threads *= 2) {
+        std::vector<StudentPtr> spawned;
+        double spawnSeconds = bench::timeSeconds([&] {
+            for (size_t i = 0; i < repeats; ++i) {
+                spawned = input;
+                spawnPerCallSort(spawned, threads);
+            }
+        });
+        
+        std::vector<StudentPtr> pooled;
+        std::vector<std::chrono::microseconds> threadTimes;
+        double poolSeconds = bench::timeSeconds([&] {
+            for (size_t i = 0; i < repeats; ++i) {
+                pooled = input;
+                StudentRegistry<std::string, std::string>::parallelSort(pooled, threads,
+                                                                         threadTimes);
+            }
+        });
+        
+        bool same = pooled.size() == spawned.size();
+        for (size_t i = 0; same && i < pooled.size(); ++i) {
+            same = !(*pooled[i] < *spawned[i]) && !(*spawned[i] < *pooled[i]);
+        }
+        if (!same) status = 1;
+        
+        std::cout << "threads=" << std::setw(2) << threads << std::fixed << std::setprecision(1)
+                  << "  spawn-per-call " << std::setw(8) << spawnSeconds * 1e6 / repeats
+                  << " us/sort  pool " << std::setw(8) << poolSeconds * 1e6 / repeats
+                  << " us/sort  speedup " << std::setprecision(2) << spawnSeconds / poolSeconds
+                  << "x" << (same ? "" : "  ORDER MISMATCH") << std::endl;
+    }
+    return status;
+}
@@ -0,0 +1,37 @@
+#include "BenchCommon.h"
+#include <cstring>
+
+// Writes a synthetic students.csv for benchmarking:
+//   gen_students <rows> <output.csv> [--int-courses] [seed]
+// rows takes an optional k or M suffix (10k, 1M, 10M). Roll numbers mix the
+// "2020CS1000", 5-digit and 6-digit shapes; course codes mix strings and
+// integers unless --int-courses is given.
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        std::cerr << "Usage: " << argv[0] << " <rows> <output.csv> [--int-courses] [seed]"
+                  << std::endl;
+        return 1;
+    }
+    char* suffix = nullptr;
+    size_t rows = static_cast<size_t>(std::strtoull(argv[1], &suffix, 10));
+    if (*suffix == 'k' || *suffix == 'K') {
+        rows *= 1000;
+    } else if (*suffix == 'm' || *suffix == 'M') {
+        rows *= 1000000;
+    }
+    std::string path = argv[2];
+    bool numericCourses = argc > 3 && std::strcmp(argv[3], "--int-courses") == 0;
+    int seedIndex = numericCourses ? 4 : 3;
+    unsigned seed = static_cast<unsigned>(bench::sizeArg(argc, argv, seedIndex, 42));
+
+    double seconds = bench::timeSeconds([&] {
+        bench::writeStudentsCsv(path, rows, seed, numericCourses);
+    });
+    if (!std::ifstream(path)) {
+        std::cerr << "Error: Could not write " << path << std::endl;
+        return 1;
+    }
+    std::cout << path << ": " << rows << " rows, " << std::fixed << std::setprecision(1)
+              << bench::fileMegabytes(path) << " MB in " << seconds << " s" << std::endl;
+    return 0;
+}
@@ -1,30 +1,51 @@
 #include "Student.h"
 #include "StudentRegistry.h"
 #include "CSVReader.h"
+#include "CommandLine.h"
+#include "StudentDataset.h"
 #include <iostream>
 #include <vector>
 #include <memory>
 #include <chrono>
 #include <iomanip>
 #include <limits>
+#include <cstdlib>
+#include <string>
 
 using namespace std;
 
+using StudentData = StudentDataset<string, string>::Data;
+
+// students.csv is read and indexed once, on first use, and shared by every
+// menu option until the file changes on disk.
+shared_ptr<const StudentData> loadStudents() {
+    static StudentDataset<string, string> dataset("students.csv");
+    bool reloaded = false;
+    auto data = dataset.get(&reloaded);
+    if (data && reloaded) {
+        cout << "Loaded " << data->registry.size() << " students from " << dataset.file()
+             << (dataset.loadCount() > 1 ? " (file changed)" : "") << "\n";
+    }
+    return data;
+}
+
 void demonstratePart1() {
     cout << "\n--- Part 1: Generic Student Class (from CSV) ---\n";
     
-    auto students = CSVReader::readStudentsStringString("students.csv");
+    auto data = loadStudents();
     
-    if (students.empty()) {
+    if (!data || data->registry.size() == 0) {
         cout << "Error: Couldn't read students from CSV\n";
         return;
     }
+    auto students = data->registry.originalView();
     
     cout << "Showing first 3 students from CSV:\n\n";
     
-    for (int i = 0; i < min(3, (int)students.size()); ++i) {
-        cout << "Student " << (i+1) << ":\n";
-        cout << *students[i] << endl << endl;
+    int shown = 0;
+    for (auto it = students.begin(); it != students.end() && shown < 3; ++it) {
+        cout << "Student " << ++shown << ":\n";
+        cout << **it << endl << endl;
     }
     
     cout << "Total students in CSV: " << students.size() << endl;
@@ -35,12 +56,13 @@ void demonstratePart1() {
 void demonstratePart2() {
     cout << "\n--- Part 2: IIIT-D students with IIT-D course support ---\n";
     
-    auto iitdStudents = CSVReader::readStudentsStringString("students.csv");
+    auto data = loadStudents();
     
-    if (iitdStudents.empty()) {
+    if (!data || data->registry.size() == 0) {
         cout << "Error: Couldn't read students from CSV\n";
         return;
     }
+    auto iitdStudents = data->registry.originalView();
     
     cout << "IIIT-D students (using string course codes like 'OOPD', 'DSA'):\n\n";
     
@@ -76,23 +98,28 @@ void demonstratePart2() {
 void demonstratePart3() {
     cout << "\n--- Part 3: Parallel sorting from CSV ---\n";
     
-    cout << "Reading students from CSV file...\n";
-    auto students = CSVReader::readStudentsStringString("students.csv");
+    auto data = loadStudents();
     
-    if (students.empty()) {
+    if (!data || data->registry.size() == 0) {
         cout << "Error: Couldn't read students from CSV\n";
         return;
     }
     
-    cout << "Read " << students.size() << " students\n";
+    // parallelSort works on its own vector, so the students are copied out
+    // of the registry for the demonstration.
+    vector<shared_ptr<Student<string, string>>> studentsToSort;
+    for (const auto* student : data->registry.originalView()) {
+        studentsToSort.push_back(make_shared<Student<string, string>>(*student));
+    }
+    cout << "Read " << studentsToSort.size() << " students\n";
     
-    auto studentsToSort = students;
     int numThreads = 2;
     vector<chrono::microseconds> threadTimes;
+    SortPhaseTimes phaseTimes;
     
     cout << "Sorting with " << numThreads << " threads...\n";
     auto startTime = chrono::high_resolution_clock::now();
-    StudentRegistry<string, string>::parallelSort(studentsToSort, numThreads, threadTimes);
+    StudentRegistry<string, string>::parallelSort(studentsToSort, numThreads, threadTimes, phaseTimes);
     auto endTime = chrono::high_resolution_clock::now();
     
     auto totalTime = chrono::duration_cast<chrono::microseconds>(endTime - startTime);
@@ -103,6 +130,8 @@ void demonstratePart3() {
         cout << "Thread " << i << ": " << threadTimes[i].count() << " μs (" 
              << fixed << setprecision(3) << ms << " ms)\n";
     }
+    cout << "Chunk sort phase: " << phaseTimes.sort.count() << " μs\n";
+    cout << "Merge phase: " << phaseTimes.merge.count() << " μs\n";
     double totalMs = totalTime.count() / 1000.0;
     cout << "Total time: " << totalTime.count() << " μs (" 
          << fixed << setprecision(3) << totalMs << " ms)\n";
@@ -126,19 +155,13 @@ void demonstratePart3() {
 void demonstratePart4() {
     cout << "\n--- Part 4: Iterators for original and sorted order ---\n";
     
-    auto students = CSVReader::readStudentsStringString("students.csv");
+    auto data = loadStudents();
     
-    if (students.empty()) {
+    if (!data || data->registry.size() == 0) {
         cout << "Error: Couldn't read students\n";
         return;
     }
-    
-    StudentRegistry<string, string> registry;
-    
-    cout << "Adding " << students.size() << " students to registry...\n";
-    for (const auto& student : students) {
-        registry.addStudent(student);
-    }
+    const auto& registry = data->registry;
     
     int orderChoice;
     bool validChoice = false;
@@ -189,19 +212,13 @@ void demonstratePart4() {
 void demonstratePart5() {
     cout << "\n--- Part 5: Finding students with high grades ---\n";
     
-    auto students = CSVReader::readStudentsStringString("students.csv");
+    auto data = loadStudents();
     
-    if (students.empty()) {
+    if (!data || data->registry.size() == 0) {
         cout << "Error: Couldn't read students\n";
         return;
     }
-    
-    StudentRegistry<string, string> registry;
-    
-    cout << "Adding " << students.size() << " students to registry...\n";
-    for (const auto& student : students) {
-        registry.addStudent(student);
-    }
+    const auto& registry = data->registry;
     
     string courseCode;
     double minGrade;
@@ -271,7 +288,36 @@ void demonstratePart5() {
     }
 }
 
-int main() {
+int main(int argc, char** argv) {
+    CommandLineOptions options;
+    if (argc > 1) {
+        if (!parseCommandLine(argc, argv, options)) {
+            printCommandLineUsage(argv[0]);
+            return 1;
+        }
+        if (options.showHelp) {
+            printCommandLineUsage(argv[0]);
+            return 0;
+        }
+    }
+
+    // ERP_METRICS_FILE=path dumps the metrics to path (JSON if it ends in
+    // .json) every ERP_METRICS_INTERVAL_MS milliseconds and on exit, in the
+    // menu and the command-line modes alike.
+    std::unique_ptr<MetricsDumper> metricsDumper;
+    if (const char* metricsFile = std::getenv("ERP_METRICS_FILE")) {
+        long intervalMs = 1000;
+        if (const char* interval = std::getenv("ERP_METRICS_INTERVAL_MS")) {
+            intervalMs = std::max(1L, std::strtol(interval, nullptr, 10));
+        }
+        metricsDumper = std::make_unique<MetricsDumper>(metricsFile,
+                                                        std::chrono::milliseconds(intervalMs));
+    }
+
+    if (argc > 1) {
+        return runCommandLine(options);
+    }
+
     cout << "University ERP System\n";
 
     int choice;